@@ -0,0 +1,81 @@
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <memory>
+#include <thread>
+#include "../include/SharedPtr.hpp"
+
+// Reference counting under contention: every thread copies and destroys either one
+// pointer shared by all threads (the counters' cache line bounces between cores) or
+// a pointer private to the thread (no sharing, the per-core baseline).
+// Run with --benchmark_filter=Contention to get throughput per thread count.
+
+struct ContentionPayload {
+    long value_ = 0;
+};
+
+template <typename Ptr>
+struct ContentionTraits;
+
+template <typename Policy>
+struct ContentionTraits<SharedPtr<ContentionPayload, Policy>> {
+    static SharedPtr<ContentionPayload, Policy> Make() { return ::make_shared<ContentionPayload, Policy>(); }
+};
+
+template <>
+struct ContentionTraits<std::shared_ptr<ContentionPayload>> {
+    static std::shared_ptr<ContentionPayload> Make() { return std::make_shared<ContentionPayload>(); }
+};
+
+
+template <typename Ptr>
+static Ptr shared_contention_ptr;
+
+template <typename Ptr>
+static void BM_ContentionSharedCopy(benchmark::State& state) {
+    if (state.thread_index() == 0) {
+        shared_contention_ptr<Ptr> = ContentionTraits<Ptr>::Make();
+    }
+    for (auto _ : state) {
+        Ptr copy(shared_contention_ptr<Ptr>);
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations());
+    if (state.thread_index() == 0) {
+        // Striped pointers are only freed after retire()
+        if constexpr (requires(Ptr& ptr) { ptr.retire(); }) {
+            shared_contention_ptr<Ptr>.retire();
+        }
+        shared_contention_ptr<Ptr> = Ptr();
+    }
+}
+
+template <typename Ptr>
+static void BM_ContentionPrivateCopy(benchmark::State& state) {
+    Ptr local = ContentionTraits<Ptr>::Make();
+    for (auto _ : state) {
+        Ptr copy(local);
+        benchmark::DoNotOptimize(copy);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+
+static const int kMaxContentionThreads = static_cast<int>(std::max(2u, std::thread::hardware_concurrency()));
+
+using OurAtomicPtr = SharedPtr<ContentionPayload, AtomicPolicy>;
+using OurPlainPtr = SharedPtr<ContentionPayload, NonAtomicPolicy>;
+using OurBiasedPtr = SharedPtr<ContentionPayload, BiasedPolicy>;
+using OurStripedPtr = SharedPtr<ContentionPayload, StripedPolicy>;
+using StdPtr = std::shared_ptr<ContentionPayload>;
+
+#define CONTENTION_BENCHMARK(Bench, Ptr) \
+    BENCHMARK_TEMPLATE(Bench, Ptr)->ThreadRange(1, kMaxContentionThreads)->UseRealTime()
+
+CONTENTION_BENCHMARK(BM_ContentionSharedCopy, OurAtomicPtr);
+CONTENTION_BENCHMARK(BM_ContentionSharedCopy, OurBiasedPtr);
+CONTENTION_BENCHMARK(BM_ContentionSharedCopy, OurStripedPtr);
+CONTENTION_BENCHMARK(BM_ContentionSharedCopy, StdPtr);
+CONTENTION_BENCHMARK(BM_ContentionPrivateCopy, OurAtomicPtr);
+CONTENTION_BENCHMARK(BM_ContentionPrivateCopy, OurPlainPtr);
+CONTENTION_BENCHMARK(BM_ContentionPrivateCopy, OurBiasedPtr);
+CONTENTION_BENCHMARK(BM_ContentionPrivateCopy, StdPtr);
@@ -0,0 +1,396 @@
+#include <benchmark/benchmark.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <iterator>
+#include <new>
+#include <span>
+#include <string>
+#include <vector>
+#include "../include/CompactSharedPtr.hpp"
+#include "../include/ObjectPool.hpp"
+#include "../include/SharedPtr.hpp"
+#include "../include/UniquePtr.hpp"
+#include "../include/WeakPtr.hpp"
+
+// Every global allocation is counted so each benchmark can report allocations/op. All the
+// replaceable forms share one malloc/free pair, kept out of line so that GCC does not see
+// free() inlined next to operator new at the call sites (-Wmismatched-new-delete).
+static thread_local size_t allocation_count = 0;
+
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE static void* CountedAllocate(size_t size, size_t alignment) noexcept {
+    ++allocation_count;
+    size = size ? size : 1;
+    if (alignment <= alignof(std::max_align_t)) {
+        return std::malloc(size);
+    }
+    // aligned_alloc wants the size rounded up to the alignment
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+BENCH_NOINLINE static void CountedFree(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+static void* CountedAllocateOrThrow(size_t size, size_t alignment) {
+    if (void* ptr = CountedAllocate(size, alignment)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+constexpr size_t kDefaultAlignment = alignof(std::max_align_t);
+
+void* operator new(size_t size) { return CountedAllocateOrThrow(size, kDefaultAlignment); }
+void* operator new[](size_t size) { return CountedAllocateOrThrow(size, kDefaultAlignment); }
+void* operator new(size_t size, std::align_val_t align) { return CountedAllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align) { return CountedAllocateOrThrow(size, static_cast<size_t>(align)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size, kDefaultAlignment); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return CountedAllocate(size, kDefaultAlignment); }
+void* operator new(size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return CountedAllocate(size, static_cast<size_t>(align)); }
+void* operator new[](size_t size, std::align_val_t align, const std::nothrow_t&) noexcept { return CountedAllocate(size, static_cast<size_t>(align)); }
+
+void operator delete(void* ptr) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, size_t, std::align_val_t) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, size_t, std::align_val_t) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+void operator delete(void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+void operator delete[](void* ptr, std::align_val_t, const std::nothrow_t&) noexcept { CountedFree(ptr); }
+
+
+struct Payload {
+    int64_t value_ = 0;
+};
+
+constexpr int64_t kBatchSize = 1024;
+
+
+class AllocationCounter {
+private:
+    benchmark::State& state_;
+    size_t start_;
+
+public:
+    explicit AllocationCounter(benchmark::State& state) : state_(state), start_(allocation_count) {}
+
+    ~AllocationCounter() {
+        state_.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocation_count - start_), benchmark::Counter::kAvgIterations);
+    }
+};
+
+
+struct OurShared {
+    using Ptr = SharedPtr<Payload>;
+    using Weak = WeakPtr<Payload>;
+    static Ptr FromRaw() { return Ptr(new Payload()); }
+    static Ptr Make() { return ::make_shared<Payload>(); }
+};
+
+struct OurAtomicShared {
+    using Ptr = SharedPtr<Payload, AtomicPolicy>;
+    using Weak = WeakPtr<Payload, AtomicPolicy>;
+    static Ptr FromRaw() { return Ptr(new Payload()); }
+    static Ptr Make() { return ::make_shared<Payload, AtomicPolicy>(); }
+};
+
+struct StdShared {
+    using Ptr = std::shared_ptr<Payload>;
+    using Weak = std::weak_ptr<Payload>;
+    static Ptr FromRaw() { return Ptr(new Payload()); }
+    static Ptr Make() { return std::make_shared<Payload>(); }
+};
+
+struct OurCompactShared {
+    using Ptr = CompactSharedPtr<Payload>;
+    static Ptr Make() { return ::make_compact_shared<Payload>(); }
+};
+
+struct OurUnique {
+    using Ptr = UniquePtr<Payload>;
+    static Ptr Make() { return ::make_unique<Payload>(); }
+};
+
+struct StdUnique {
+    using Ptr = std::unique_ptr<Payload>;
+    static Ptr Make() { return std::make_unique<Payload>(); }
+};
+
+
+// Construction includes the matching destruction, the pair cannot be split per operation
+template <typename Traits>
+static void BM_SharedFromRaw(benchmark::State& state) {
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr ptr = Traits::FromRaw();
+        benchmark::DoNotOptimize(ptr);
+    }
+}
+
+template <typename Traits>
+static void BM_SharedMake(benchmark::State& state) {
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr ptr = Traits::Make();
+        benchmark::DoNotOptimize(ptr);
+    }
+}
+
+template <typename Traits>
+static void BM_SharedCopy(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr copy(ptr);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+
+template <typename Traits>
+static void BM_SharedMove(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr moved(std::move(ptr));
+        benchmark::DoNotOptimize(moved);
+        ptr = std::move(moved);
+    }
+}
+
+// Destroys batches of last owners; building the batch is excluded from the timing
+template <typename Traits>
+static void BM_SharedDestroy(benchmark::State& state) {
+    std::vector<typename Traits::Ptr> ptrs;
+    ptrs.reserve(kBatchSize);
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int64_t i = 0; i < kBatchSize; ++i) {
+            ptrs.push_back(Traits::Make());
+        }
+        size_t start = allocation_count;
+        state.ResumeTiming();
+        ptrs.clear();
+        allocations += allocation_count - start;
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations) / kBatchSize, benchmark::Counter::kAvgIterations);
+}
+
+template <typename Traits>
+static void BM_SharedUseCount(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(ptr.use_count());
+    }
+}
+
+template <typename Traits>
+static void BM_WeakLock(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    typename Traits::Weak weak(ptr);
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr locked = weak.lock();
+        benchmark::DoNotOptimize(locked);
+    }
+}
+
+template <typename Traits>
+static void BM_WeakLockExpired(benchmark::State& state) {
+    typename Traits::Weak weak;
+    {
+        typename Traits::Ptr ptr = Traits::Make();
+        weak = ptr;
+    }
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr locked = weak.lock();
+        benchmark::DoNotOptimize(locked);
+    }
+}
+
+template <typename Traits>
+static void BM_WeakCopy(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    typename Traits::Weak weak(ptr);
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Weak copy(weak);
+        benchmark::DoNotOptimize(copy);
+    }
+}
+
+template <typename Traits>
+static void BM_UniqueMake(benchmark::State& state) {
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr ptr = Traits::Make();
+        benchmark::DoNotOptimize(ptr);
+    }
+}
+
+template <typename Traits>
+static void BM_UniqueMove(benchmark::State& state) {
+    typename Traits::Ptr ptr = Traits::Make();
+    AllocationCounter counter(state);
+    for (auto _ : state) {
+        typename Traits::Ptr moved(std::move(ptr));
+        benchmark::DoNotOptimize(moved);
+        ptr = std::move(moved);
+    }
+}
+
+template <typename Traits>
+static void BM_UniqueDestroy(benchmark::State& state) {
+    std::vector<typename Traits::Ptr> ptrs;
+    ptrs.reserve(kBatchSize);
+    size_t allocations = 0;
+    for (auto _ : state) {
+        state.PauseTiming();
+        for (int64_t i = 0; i < kBatchSize; ++i) {
+            ptrs.push_back(Traits::Make());
+        }
+        size_t start = allocation_count;
+        state.ResumeTiming();
+        ptrs.clear();
+        allocations += allocation_count - start;
+    }
+    state.SetItemsProcessed(state.iterations() * kBatchSize);
+    state.counters["allocs/op"] = benchmark::Counter(static_cast<double>(allocations) / kBatchSize, benchmark::Counter::kAvgIterations);
+}
+
+
+// Reads through a vector of pointers; the pointer size decides how many fit per cache line
+template <typename Traits>
+static void BM_PointerScan(benchmark::State& state) {
+    std::vector<typename Traits::Ptr> ptrs;
+    ptrs.reserve(static_cast<size_t>(state.range(0)));
+    for (int64_t i = 0; i < state.range(0); ++i) {
+        ptrs.push_back(Traits::Make());
+    }
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& ptr : ptrs) {
+            sum += ptr->value_;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+// Broadcast: hand one object to n consumers and drop all of them again
+template <typename Traits>
+static void BM_FanOutLoop(benchmark::State& state) {
+    typename Traits::Ptr source = Traits::Make();
+    std::vector<typename Traits::Ptr> consumers;
+    consumers.reserve(static_cast<size_t>(state.range(0)));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        for (int64_t i = 0; i < state.range(0); ++i) {
+            consumers.push_back(source);
+        }
+        consumers.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+template <typename Traits>
+static void BM_FanOutBulk(benchmark::State& state) {
+    typename Traits::Ptr source = Traits::Make();
+    std::vector<typename Traits::Ptr> consumers;
+    consumers.reserve(static_cast<size_t>(state.range(0)));
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        source.share_n(static_cast<size_t>(state.range(0)), std::back_inserter(consumers));
+        release_all(std::span(consumers));
+        consumers.clear();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+
+// Objects with heap-owning members, built from scratch or recycled by an ObjectPool
+struct HeavyPayload {
+    std::string name_;
+    std::vector<int> data_;
+
+    void Fill() {
+        name_.assign("a resource name too long for the small string buffer");
+        data_.assign(64, 1);
+    }
+};
+
+static void BM_HeavyMake(benchmark::State& state) {
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        SharedPtr<HeavyPayload> resource = ::make_shared<HeavyPayload>();
+        resource->Fill();
+        benchmark::DoNotOptimize(resource);
+    }
+}
+
+static void BM_HeavyPooled(benchmark::State& state) {
+    ObjectPool<HeavyPayload> pool([] { return new HeavyPayload(); }, [](HeavyPayload& payload) {
+        payload.name_.clear();
+        payload.data_.clear();
+    });
+    AllocationCounter allocations(state);
+    for (auto _ : state) {
+        SharedPtr<HeavyPayload> resource = pool.acquire();
+        resource->Fill();
+        benchmark::DoNotOptimize(resource);
+    }
+}
+
+
+#define SHARED_BENCHMARKS(Bench) \
+    BENCHMARK_TEMPLATE(Bench, OurShared); \
+    BENCHMARK_TEMPLATE(Bench, OurAtomicShared); \
+    BENCHMARK_TEMPLATE(Bench, StdShared)
+
+#define UNIQUE_BENCHMARKS(Bench) \
+    BENCHMARK_TEMPLATE(Bench, OurUnique); \
+    BENCHMARK_TEMPLATE(Bench, StdUnique)
+
+SHARED_BENCHMARKS(BM_SharedFromRaw);
+SHARED_BENCHMARKS(BM_SharedMake);
+SHARED_BENCHMARKS(BM_SharedCopy);
+SHARED_BENCHMARKS(BM_SharedMove);
+SHARED_BENCHMARKS(BM_SharedDestroy);
+SHARED_BENCHMARKS(BM_SharedUseCount);
+SHARED_BENCHMARKS(BM_WeakLock);
+SHARED_BENCHMARKS(BM_WeakLockExpired);
+SHARED_BENCHMARKS(BM_WeakCopy);
+
+BENCHMARK_TEMPLATE(BM_FanOutLoop, OurAtomicShared)->Arg(64);
+BENCHMARK_TEMPLATE(BM_FanOutBulk, OurAtomicShared)->Arg(64);
+BENCHMARK_TEMPLATE(BM_FanOutLoop, StdShared)->Arg(64);
+
+BENCHMARK_TEMPLATE(BM_PointerScan, OurShared)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_PointerScan, OurCompactShared)->Range(1 << 10, 1 << 18);
+BENCHMARK_TEMPLATE(BM_PointerScan, StdShared)->Range(1 << 10, 1 << 18);
+
+BENCHMARK(BM_HeavyMake);
+BENCHMARK(BM_HeavyPooled);
+
+UNIQUE_BENCHMARKS(BM_UniqueMake);
+UNIQUE_BENCHMARKS(BM_UniqueMove);
+UNIQUE_BENCHMARKS(BM_UniqueDestroy);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,207 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include "SharedPtr.hpp"
+
+// Atomic slot holding a SharedPtr<T, AtomicPolicy>, for read-mostly data published by a writer.
+//
+// Uses split reference counting: the slot packs a pointer to an immutable node (which owns one
+// reference to the published value) together with a count of readers currently copying out of
+// that node. A reader takes a ticket with one CAS, copies the SharedPtr and hands the ticket back.
+// A writer that swaps the node out moves the outstanding tickets onto the node itself, and the
+// last ticket holder frees it. No operation takes a lock, so readers never block on writers.
+template <typename T>
+class AtomicSharedPtr {
+public:
+    using Ptr = SharedPtr<T, AtomicPolicy>;
+
+private:
+    struct Node {
+        Ptr value_;
+        // Tickets transferred by the writer minus tickets returned after the swap
+        std::atomic<intptr_t> pending_tickets_;
+
+        explicit Node(Ptr value) : value_(std::move(value)), pending_tickets_(0) {}
+    };
+
+    static_assert(sizeof(void*) == 8, "AtomicSharedPtr packs a 48-bit pointer and a 16-bit count");
+
+    static constexpr int kTicketShift = 48;
+    static constexpr uintptr_t kPointerMask = (uintptr_t(1) << kTicketShift) - 1;
+    static constexpr uintptr_t kOneTicket = uintptr_t(1) << kTicketShift;
+    static constexpr uintptr_t kMaxTickets = (uintptr_t(1) << (64 - kTicketShift)) - 1;
+
+    mutable std::atomic<uintptr_t> word_;
+
+    static Node* NodeOf(uintptr_t word) noexcept {
+        return reinterpret_cast<Node*>(word & kPointerMask);
+    }
+
+    static uintptr_t TicketsOf(uintptr_t word) noexcept {
+        return word >> kTicketShift;
+    }
+
+    // Values without a control block are stored as a null node
+    static uintptr_t MakeWord(Ptr value) {
+        if (value.use_count() == 0 && value.get() == nullptr) {
+            return 0;
+        }
+        Node* node = new Node(std::move(value));
+        uintptr_t word = reinterpret_cast<uintptr_t>(node);
+        if ((word & ~kPointerMask) != 0) {
+            delete node;
+            throw std::runtime_error("AtomicSharedPtr: node address does not fit in 48 bits");
+        }
+        return word;
+    }
+
+    static void DropTickets(Node* node, intptr_t count) noexcept {
+        if (node->pending_tickets_.fetch_add(count, std::memory_order_acq_rel) + count == 0) {
+            delete node;
+        }
+    }
+
+    // Returns the observed word with our ticket already included in it
+    uintptr_t AcquireTicket() const noexcept {
+        uintptr_t word = word_.load(std::memory_order_acquire);
+        while (true) {
+            if (NodeOf(word) == nullptr) {
+                return word;
+            }
+            if (TicketsOf(word) == kMaxTickets) {
+                std::this_thread::yield();
+                word = word_.load(std::memory_order_acquire);
+                continue;
+            }
+            if (word_.compare_exchange_weak(word, word + kOneTicket, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return word + kOneTicket;
+            }
+        }
+    }
+
+    // The node cannot be freed while we hold a ticket, so comparing addresses is ABA-safe
+    void ReleaseTicket(Node* node) const noexcept {
+        uintptr_t word = word_.load(std::memory_order_relaxed);
+        while (NodeOf(word) == node) {
+            if (word_.compare_exchange_weak(word, word - kOneTicket, std::memory_order_release, std::memory_order_relaxed)) {
+                return;
+            }
+        }
+        DropTickets(node, -1);
+    }
+
+    static bool Equivalent(const Node* node, const Ptr& value) noexcept {
+        if (node == nullptr) {
+            return value.use_count() == 0 && value.get() == nullptr;
+        }
+        return node->value_.get() == value.get() && node->value_.owner_equal(value);
+    }
+
+public:
+    constexpr AtomicSharedPtr() noexcept : word_(0) {}
+
+    AtomicSharedPtr(Ptr value) : word_(MakeWord(std::move(value))) {}
+
+    AtomicSharedPtr(const AtomicSharedPtr&) = delete;
+    AtomicSharedPtr& operator=(const AtomicSharedPtr&) = delete;
+
+    ~AtomicSharedPtr() {
+        if (Node* node = NodeOf(word_.load(std::memory_order_acquire))) {
+            delete node;
+        }
+    }
+
+    static constexpr bool is_always_lock_free = true;
+
+    bool is_lock_free() const noexcept {
+        return true;
+    }
+
+    Ptr load() const {
+        uintptr_t word = AcquireTicket();
+        Node* node = NodeOf(word);
+        if (node == nullptr) {
+            return Ptr();
+        }
+        Ptr result(node->value_);
+        ReleaseTicket(node);
+        return result;
+    }
+
+    operator Ptr() const {
+        return load();
+    }
+
+    void store(Ptr desired) {
+        exchange(std::move(desired));
+    }
+
+    AtomicSharedPtr& operator=(Ptr desired) {
+        store(std::move(desired));
+        return *this;
+    }
+
+    Ptr exchange(Ptr desired) {
+        uintptr_t old_word = word_.exchange(MakeWord(std::move(desired)), std::memory_order_acq_rel);
+        Node* old_node = NodeOf(old_word);
+        if (old_node == nullptr) {
+            return Ptr();
+        }
+        // Readers holding tickets may still be copying value_, so it is copied rather than moved
+        Ptr result(old_node->value_);
+        DropTickets(old_node, static_cast<intptr_t>(TicketsOf(old_word)));
+        return result;
+    }
+
+    // Succeeds when the stored value points to the same object and shares ownership with expected
+    bool compare_exchange_strong(Ptr& expected, Ptr desired) {
+        uintptr_t desired_word = 0;
+        bool desired_ready = false;
+
+        while (true) {
+            uintptr_t word = AcquireTicket();
+            Node* node = NodeOf(word);
+
+            if (!Equivalent(node, expected)) {
+                if (node) {
+                    expected = node->value_;
+                    ReleaseTicket(node);
+                }
+                else {
+                    expected = Ptr();
+                }
+                if (desired_ready && desired_word) {
+                    delete NodeOf(desired_word);
+                }
+                return false;
+            }
+
+            if (!desired_ready) {
+                desired_word = MakeWord(std::move(desired));
+                desired_ready = true;
+            }
+
+            while (NodeOf(word) == node) {
+                if (word_.compare_exchange_weak(word, desired_word, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                    if (node) {
+                        // Our own ticket is settled here rather than returned
+                        DropTickets(node, static_cast<intptr_t>(TicketsOf(word)) - 1);
+                    }
+                    return true;
+                }
+            }
+
+            if (node) {
+                ReleaseTicket(node);
+            }
+        }
+    }
+
+    bool compare_exchange_weak(Ptr& expected, Ptr desired) {
+        return compare_exchange_strong(expected, std::move(desired));
+    }
+};
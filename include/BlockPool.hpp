@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <new>
+
+// Per-thread freelists of small fixed-size blocks (16-byte size classes up to 256 bytes).
+// Freed blocks are cached by the thread that frees them, so in steady state creating
+// and destroying control blocks never reaches the global allocator.
+class BlockPool {
+private:
+    struct FreeNode {
+        FreeNode* next_;
+    };
+
+    static constexpr size_t kGranularity = 16;
+    static constexpr size_t kClassCount = 16;
+    static constexpr size_t kMaxCachedPerClass = 4096;
+
+    // Trivially destructible, so it stays usable for the whole lifetime of the thread
+    struct Cache {
+        FreeNode* heads_[kClassCount];
+        size_t cached_[kClassCount];
+        bool closed_;
+    };
+
+    // Returns the cached blocks to the global allocator when the thread exits
+    struct Drainer {
+        ~Drainer() {
+            Cache& cache = cache_;
+            cache.closed_ = true;
+            for (size_t i = 0; i < kClassCount; ++i) {
+                while (cache.heads_[i]) {
+                    FreeNode* node = cache.heads_[i];
+                    cache.heads_[i] = node->next_;
+                    ::operator delete(node);
+                }
+                cache.cached_[i] = 0;
+            }
+        }
+    };
+
+    static inline thread_local Cache cache_{};
+
+    static constexpr size_t SizeClass(size_t size) noexcept {
+        return (size + kGranularity - 1) / kGranularity - 1;
+    }
+
+public:
+    static constexpr size_t kMaxBlockSize = kGranularity * kClassCount;
+
+    static void* Allocate(size_t size) {
+        if (size > kMaxBlockSize) {
+            return ::operator new(size);
+        }
+
+        size_t index = SizeClass(size);
+        Cache& cache = cache_;
+        if (FreeNode* node = cache.heads_[index]) {
+            cache.heads_[index] = node->next_;
+            --cache.cached_[index];
+            return node;
+        }
+        return ::operator new((index + 1) * kGranularity);
+    }
+
+    static void Deallocate(void* ptr, size_t size) noexcept {
+        if (ptr == nullptr) {
+            return;
+        }
+
+        size_t index = SizeClass(size);
+        Cache& cache = cache_;
+        if (size > kMaxBlockSize || cache.closed_ || cache.cached_[index] == kMaxCachedPerClass) {
+            ::operator delete(ptr);
+            return;
+        }
+
+        static thread_local Drainer drainer;
+        (void)drainer;
+
+        FreeNode* node = static_cast<FreeNode*>(ptr);
+        node->next_ = cache.heads_[index];
+        cache.heads_[index] = node;
+        ++cache.cached_[index];
+    }
+};
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <utility>
+#include "ControlBlock.hpp"
+#include "SharedPtr.hpp"
+#include "TriviallyRelocatable.hpp"
+
+template <typename T, typename Policy = NonAtomicPolicy, typename... Args>
+CompactSharedPtr<T, Policy> make_compact_shared(Args&&... args);
+
+// One-word shared pointer for objects created by make_compact_shared. It keeps only the
+// in-place control block; the object sits at a fixed offset inside it, so get() is pure
+// address arithmetic. Converts to SharedPtr (and through it to WeakPtr) sharing the count.
+template <typename T, typename Policy>
+class CompactSharedPtr {
+private:
+    InplaceControlBlock<T, Policy>* block_;
+
+    // Takes over the count of a pointer that make_shared just returned
+    explicit CompactSharedPtr(SharedPtr<T, Policy>&& shared) noexcept
+        : block_(static_cast<InplaceControlBlock<T, Policy>*>(shared.ref_counter_)) {
+        shared.ptr_ = nullptr;
+        shared.ref_counter_ = nullptr;
+    }
+
+public:
+    constexpr CompactSharedPtr() noexcept : block_(nullptr) {}
+
+    constexpr CompactSharedPtr(std::nullptr_t) noexcept : block_(nullptr) {}
+
+    CompactSharedPtr(const CompactSharedPtr& other) noexcept : block_(other.block_) {
+        if (block_) {
+            block_->IncrementShared();
+        }
+    }
+
+    CompactSharedPtr(CompactSharedPtr&& other) noexcept : block_(other.block_) {
+        other.block_ = nullptr;
+    }
+
+    ~CompactSharedPtr() {
+        if (block_) {
+            block_->ReleaseShared();
+        }
+    }
+
+    CompactSharedPtr& operator=(const CompactSharedPtr& other) noexcept {
+        CompactSharedPtr(other).swap(*this);
+        return *this;
+    }
+
+    CompactSharedPtr& operator=(CompactSharedPtr&& other) noexcept {
+        CompactSharedPtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    // Shares ownership with a regular SharedPtr; the block stays the same
+    operator SharedPtr<T, Policy>() const noexcept {
+        return block_ ? SharedPtr<T, Policy>(block_->Get(), block_) : SharedPtr<T, Policy>();
+    }
+
+    SharedPtr<T, Policy> to_shared() const noexcept {
+        return *this;
+    }
+
+    const T* get() const noexcept {
+        return block_ ? block_->Get() : nullptr;
+    }
+
+    explicit operator bool() const noexcept {
+        return block_ != nullptr;
+    }
+
+    T& operator*() const {
+        if (block_ == nullptr) {
+            throw std::runtime_error("Dereferencing a nullptr");
+        }
+        return *block_->Get();
+    }
+
+    // Unchecked, like SharedPtr::operator->, so scans pay no branch per element
+    T* operator->() const noexcept {
+        return block_->Get();
+    }
+
+    size_t use_count() const noexcept {
+        return block_ ? block_->SharedCount() : 0;
+    }
+
+    void reset() noexcept {
+        CompactSharedPtr().swap(*this);
+    }
+
+    void swap(CompactSharedPtr& other) noexcept {
+        std::swap(block_, other.block_);
+    }
+
+    bool operator==(const CompactSharedPtr& other) const noexcept {
+        return block_ == other.block_;
+    }
+
+    template <typename U, typename P, typename... Args>
+    friend CompactSharedPtr<U, P> make_compact_shared(Args&&... args);
+};
+
+
+template <typename T, typename Policy>
+struct IsTriviallyRelocatable<CompactSharedPtr<T, Policy>> : std::true_type {};
+
+
+// Goes through make_shared, so EnableSharedFromThis and the debug hooks see the object as usual
+template <typename T, typename Policy, typename... Args>
+CompactSharedPtr<T, Policy> make_compact_shared(Args&&... args) {
+    return CompactSharedPtr<T, Policy>(make_shared<T, Policy>(std::forward<Args>(args)...));
+}
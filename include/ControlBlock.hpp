@@ -1,41 +1,341 @@
 #pragma once
 #include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+#include "BlockPool.hpp"
+#include "Instrumentation.hpp"
+#include "LeakRegistry.hpp"
+#include "RefCountPolicy.hpp"
 
-class ControlBlock {
+template <typename Policy>
+struct WeakCounterOf {
+    using Type = typename Policy::Counter;
+};
+
+template <typename Policy>
+    requires requires { typename Policy::WeakCounter; }
+struct WeakCounterOf<Policy> {
+    using Type = typename Policy::WeakCounter;
+};
+
+
+// The strong owners collectively hold one weak reference, so the block is freed
+// exactly once, by whoever drops the last weak reference
+template <typename Policy>
+class BasicControlBlock {
 private:
-    size_t shared_counter_;
-    size_t weak_counter_;
+    typename Policy::Counter shared_counter_;
+    typename WeakCounterOf<Policy>::Type weak_counter_;
 
 public:
-    ControlBlock() : shared_counter_(0), weak_counter_(0) {}
+    BasicControlBlock() : shared_counter_(1), weak_counter_(1) {
+        SMARTPTR_COUNT(BlocksCreated);
+        SMARTPTR_REGISTER_BLOCK(this);
+        // Policies that can discover a zero count after the fact (BiasedPolicy) call back into the block
+        if constexpr (requires { shared_counter_.SetZeroHandler(&OnSharedZero, this); }) {
+            shared_counter_.SetZeroHandler(&OnSharedZero, this);
+        }
+        if constexpr (requires { weak_counter_.SetZeroHandler(&OnWeakZero, this); }) {
+            weak_counter_.SetZeroHandler(&OnWeakZero, this);
+        }
+    }
 
-    ControlBlock(bool is_shared_) : shared_counter_(is_shared_ ? 1 : 0), weak_counter_(is_shared_ ? 0 : 1) {}
+    virtual ~BasicControlBlock() {
+        SMARTPTR_COUNT(BlocksDestroyed);
+        SMARTPTR_UNREGISTER_BLOCK(this);
+    }
+
+    // Destroys the managed object once the last SharedPtr lets go of it
+    virtual void DisposeObject() noexcept = 0;
+
+    // Frees the block itself once the last WeakPtr lets go of it
+    virtual void DestroyBlock() noexcept {
+        delete this;
+    }
+
+    // Control blocks are recycled through per-thread freelists instead of the global heap
+    static void* operator new(size_t size) {
+        return BlockPool::Allocate(size);
+    }
+
+    static void operator delete(void* ptr, size_t size) noexcept {
+        BlockPool::Deallocate(ptr, size);
+    }
+
+    static void* operator new(size_t size, std::align_val_t align) {
+        return ::operator new(size, align);
+    }
+
+    static void operator delete(void* ptr, size_t size, std::align_val_t align) noexcept {
+        ::operator delete(ptr, size, align);
+    }
 
     void IncrementShared() noexcept {
-        ++shared_counter_;
+        SMARTPTR_COUNT(SharedIncrements);
+        shared_counter_.Increment();
     }
 
-    void DecrementShared() noexcept {
-        if (shared_counter_ > 0) {
-            --shared_counter_;
+    bool TryIncrementShared() noexcept {
+        if (!shared_counter_.IncrementIfNonZero()) {
+            return false;
         }
+        SMARTPTR_COUNT(SharedIncrements);
+        return true;
+    }
+
+    bool DecrementShared() noexcept {
+        SMARTPTR_COUNT(SharedDecrements);
+        return shared_counter_.Decrement();
+    }
+
+    void AddShared(size_t n) noexcept {
+        SMARTPTR_COUNT(SharedIncrements);
+        shared_counter_.Add(n);
+    }
+
+    bool SubShared(size_t n) noexcept {
+        SMARTPTR_COUNT(SharedDecrements);
+        return shared_counter_.Sub(n);
     }
 
     size_t SharedCount() const noexcept {
-        return shared_counter_;
+        return shared_counter_.Load();
     }
 
     void IncrementWeak() noexcept {
-        ++weak_counter_;
+        SMARTPTR_COUNT(WeakIncrements);
+        weak_counter_.Increment();
     }
 
-    void DecrementWeak() noexcept {
-        if (weak_counter_ > 0) {
-            --weak_counter_;
-        }
+    bool DecrementWeak() noexcept {
+        SMARTPTR_COUNT(WeakDecrements);
+        return weak_counter_.Decrement();
     }
 
     size_t WeakCount() const noexcept {
-        return weak_counter_;
+        size_t weak = weak_counter_.Load();
+        return SharedCount() > 0 ? weak - 1 : weak;
+    }
+
+    void ReleaseShared() noexcept {
+        if (DecrementShared()) {
+            DisposeObject();
+            ReleaseWeak();
+        }
+    }
+
+    // Drops n strong references in one step (release_all)
+    void ReleaseShared(size_t n) noexcept {
+        if (SubShared(n)) {
+            DisposeObject();
+            ReleaseWeak();
+        }
+    }
+
+    void ReleaseWeak() noexcept {
+        if (DecrementWeak()) {
+            DestroyBlock();
+        }
+    }
+
+    // Ends striped counting (StripedPolicy); the object goes once the last owner lets go
+    void RetireShared() noexcept
+        requires requires(typename Policy::Counter& counter) { counter.Retire(); }
+    {
+        if (shared_counter_.Retire()) {
+            DisposeObject();
+            ReleaseWeak();
+        }
+    }
+
+    // Drops a strong reference whose object was already disposed by the caller
+    void ReleaseDisposed() noexcept {
+        if (DecrementShared()) {
+            ReleaseWeak();
+        }
+    }
+
+    // True when the caller's reference is the only one of either kind
+    bool Unique() const noexcept {
+        return SharedCount() == 1 && WeakCount() == 0;
+    }
+
+private:
+    static void OnSharedZero(void* block) noexcept {
+        BasicControlBlock* self = static_cast<BasicControlBlock*>(block);
+        self->DisposeObject();
+        self->ReleaseWeak();
+    }
+
+    static void OnWeakZero(void* block) noexcept {
+        static_cast<BasicControlBlock*>(block)->DestroyBlock();
+    }
+};
+
+using ControlBlock = BasicControlBlock<NonAtomicPolicy>;
+
+
+// Control block for objects allocated separately by the caller (SharedPtr<T>(new T(...)))
+template <typename T, typename Policy = NonAtomicPolicy>
+class PointerControlBlock : public BasicControlBlock<Policy> {
+private:
+    T* ptr_;
+
+public:
+    explicit PointerControlBlock(T* ptr) : ptr_(ptr) {
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), ptr);
+    }
+
+    void DisposeObject() noexcept override {
+        SMARTPTR_TRACK_LIVE(T, -1);
+        delete ptr_;
+        ptr_ = nullptr;
+    }
+
+    // Lets a unique owner swap in a new object without a new block (SharedPtr::reset)
+    void Rebind(T* ptr) noexcept {
+        T* old_ptr = ptr_;
+        ptr_ = ptr;
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), ptr);
+        SMARTPTR_TRACK_LIVE(T, -1);
+        delete old_ptr;
+    }
+};
+
+
+// Control block for objects released through a user-supplied deleter (SharedPtr<T>(p, deleter))
+template <typename T, typename Deleter, typename Policy = NonAtomicPolicy>
+class DeleterControlBlock : public BasicControlBlock<Policy> {
+private:
+    T* ptr_;
+    [[no_unique_address]] Deleter deleter_;
+
+public:
+    DeleterControlBlock(T* ptr, const Deleter& deleter) : ptr_(ptr), deleter_(deleter) {
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), ptr);
+    }
+
+    void DisposeObject() noexcept override {
+        SMARTPTR_TRACK_LIVE(T, -1);
+        deleter_(ptr_);
+        ptr_ = nullptr;
+    }
+};
+
+
+// Same as DeleterControlBlock, with the block itself taken from a user allocator
+template <typename T, typename Deleter, typename Alloc, typename Policy = NonAtomicPolicy>
+class AllocatedDeleterControlBlock : public DeleterControlBlock<T, Deleter, Policy> {
+private:
+    using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<AllocatedDeleterControlBlock>;
+
+    BlockAlloc alloc_;
+
+    AllocatedDeleterControlBlock(T* ptr, const Deleter& deleter, const Alloc& alloc)
+        : DeleterControlBlock<T, Deleter, Policy>(ptr, deleter), alloc_(alloc) {}
+
+public:
+    static AllocatedDeleterControlBlock* Create(T* ptr, const Deleter& deleter, const Alloc& alloc) {
+        BlockAlloc block_alloc(alloc);
+        AllocatedDeleterControlBlock* block = std::allocator_traits<BlockAlloc>::allocate(block_alloc, 1);
+        try {
+            ::new (static_cast<void*>(block)) AllocatedDeleterControlBlock(ptr, deleter, alloc);
+        }
+        catch (...) {
+            std::allocator_traits<BlockAlloc>::deallocate(block_alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    void DestroyBlock() noexcept override {
+        BlockAlloc block_alloc(alloc_);
+        this->~AllocatedDeleterControlBlock();
+        std::allocator_traits<BlockAlloc>::deallocate(block_alloc, this, 1);
+    }
+};
+
+// Control block that stores the object itself right after the counters (make_shared)
+template <typename T, typename Policy = NonAtomicPolicy>
+class InplaceControlBlock : public BasicControlBlock<Policy> {
+private:
+    alignas(T) unsigned char storage_[sizeof(T)];
+
+public:
+    template <typename... Args>
+    explicit InplaceControlBlock(Args&&... args) {
+        ::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), Get());
+    }
+
+    T* Get() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    void DisposeObject() noexcept override {
+        SMARTPTR_TRACK_LIVE(T, -1);
+        Get()->~T();
+    }
+
+    // Builds a new object in the storage of a disposed one (SharedPtr::reset_emplace)
+    template <typename... Args>
+    void Emplace(Args&&... args) {
+        ::new (static_cast<void*>(storage_)) T(std::forward<Args>(args)...);
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), Get());
+    }
+};
+
+
+// Control block for allocate_shared: the block and the object come from a user allocator
+template <typename T, typename Alloc, typename Policy = NonAtomicPolicy>
+class AllocatedControlBlock : public BasicControlBlock<Policy> {
+private:
+    using ObjectAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+    using BlockAlloc = typename std::allocator_traits<Alloc>::template rebind_alloc<AllocatedControlBlock>;
+
+    ObjectAlloc alloc_;
+    alignas(T) unsigned char storage_[sizeof(T)];
+
+    template <typename... Args>
+    explicit AllocatedControlBlock(const Alloc& alloc, Args&&... args) : alloc_(alloc) {
+        std::allocator_traits<ObjectAlloc>::construct(alloc_, Get(), std::forward<Args>(args)...);
+        SMARTPTR_TRACK_LIVE(T, 1);
+        SMARTPTR_DESCRIBE_BLOCK(static_cast<BasicControlBlock<Policy>*>(this), Get());
+    }
+
+public:
+    template <typename... Args>
+    static AllocatedControlBlock* Create(const Alloc& alloc, Args&&... args) {
+        BlockAlloc block_alloc(alloc);
+        AllocatedControlBlock* block = std::allocator_traits<BlockAlloc>::allocate(block_alloc, 1);
+        try {
+            ::new (static_cast<void*>(block)) AllocatedControlBlock(alloc, std::forward<Args>(args)...);
+        }
+        catch (...) {
+            std::allocator_traits<BlockAlloc>::deallocate(block_alloc, block, 1);
+            throw;
+        }
+        return block;
+    }
+
+    T* Get() noexcept {
+        return std::launder(reinterpret_cast<T*>(storage_));
+    }
+
+    void DisposeObject() noexcept override {
+        SMARTPTR_TRACK_LIVE(T, -1);
+        std::allocator_traits<ObjectAlloc>::destroy(alloc_, Get());
+    }
+
+    void DestroyBlock() noexcept override {
+        BlockAlloc block_alloc(alloc_);
+        this->~AllocatedControlBlock();
+        std::allocator_traits<BlockAlloc>::deallocate(block_alloc, this, 1);
     }
 };
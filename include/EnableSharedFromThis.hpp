@@ -0,0 +1,53 @@
+#pragma once
+#include <memory>
+#include "SharedPtr.hpp"
+#include "WeakPtr.hpp"
+
+// Base for objects that need owning references to themselves. The SharedPtr constructors and
+// make_shared fill weak_this_ in, so shared_from_this() shares the existing control block.
+template <typename T, typename Policy>
+class EnableSharedFromThis {
+private:
+    mutable WeakPtr<T, Policy> weak_this_;
+
+protected:
+    constexpr EnableSharedFromThis() noexcept = default;
+
+    // A copy is a different object, so it must not inherit the original's owner
+    EnableSharedFromThis(const EnableSharedFromThis&) noexcept {}
+
+    EnableSharedFromThis& operator=(const EnableSharedFromThis&) noexcept {
+        return *this;
+    }
+
+    ~EnableSharedFromThis() = default;
+
+public:
+    // Throws std::bad_weak_ptr when the object is not owned by a SharedPtr (yet or anymore)
+    SharedPtr<T, Policy> shared_from_this() {
+        SharedPtr<T, Policy> self(weak_this_);
+        if (!self) {
+            throw std::bad_weak_ptr();
+        }
+        return self;
+    }
+
+    SharedPtr<const T, Policy> shared_from_this() const {
+        SharedPtr<const T, Policy> self{WeakPtr<const T, Policy>(weak_this_)};
+        if (!self) {
+            throw std::bad_weak_ptr();
+        }
+        return self;
+    }
+
+    WeakPtr<T, Policy> weak_from_this() noexcept {
+        return weak_this_;
+    }
+
+    WeakPtr<const T, Policy> weak_from_this() const noexcept {
+        return weak_this_;
+    }
+
+    template <typename U, typename P>
+    friend class SharedPtr;
+};
@@ -0,0 +1,203 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Hazard-pointer reclamation for lock-free structures that hand out raw pointers.
+// A reader publishes the pointer it is about to use in its own slot (one store to a
+// thread-owned cache line, no shared counter), and a writer retires replaced objects
+// instead of deleting them. Retired objects are freed in batches, once no slot
+// protects them.
+class HazardDomain {
+public:
+    static constexpr size_t kMaxSlots = 256;
+    static constexpr size_t kRetireThreshold = 2 * kMaxSlots;
+
+    struct alignas(64) Slot {
+        std::atomic<const void*> ptr_{nullptr};
+        std::atomic<bool> in_use_{false};
+    };
+
+private:
+    struct Retired {
+        HazardDomain* domain_;
+        void* ptr_;
+        void (*deleter_)(void*);
+    };
+
+    // Objects retired by the calling thread, in any domain
+    struct RetireList {
+        std::vector<Retired> retired_;
+        // Entries still protected after a scan stay in the list, so the next scan waits for
+        // another kRetireThreshold retirements instead of running on every retire()
+        size_t next_scan_ = kRetireThreshold;
+
+        ~RetireList() {
+            // Whatever is still protected goes to its domain's orphan list
+            std::vector<Retired> pending;
+            pending.swap(retired_);
+            for (const Retired& entry : pending) {
+                entry.domain_->Adopt(entry);
+            }
+        }
+    };
+
+    Slot slots_[kMaxSlots];
+    std::atomic<size_t> slots_used_{0};
+
+    std::mutex orphans_mutex_;
+    std::vector<Retired> orphans_;
+
+    static RetireList& LocalRetireList() {
+        static thread_local RetireList list;
+        return list;
+    }
+
+    void Adopt(const Retired& entry) {
+        std::lock_guard<std::mutex> lock(orphans_mutex_);
+        orphans_.push_back(entry);
+    }
+
+    std::vector<const void*> CollectHazards() {
+        // Pairs with the seq_cst publication in HazardPointer::protect
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+
+        std::vector<const void*> hazards;
+        size_t used = slots_used_.load(std::memory_order_acquire);
+        hazards.reserve(used);
+        for (size_t i = 0; i < used; ++i) {
+            if (const void* ptr = slots_[i].ptr_.load(std::memory_order_acquire)) {
+                hazards.push_back(ptr);
+            }
+        }
+        std::sort(hazards.begin(), hazards.end());
+        return hazards;
+    }
+
+    // Frees every entry of this domain that no slot protects, keeps the rest
+    void Scan(std::vector<Retired>& retired) {
+        std::vector<const void*> hazards = CollectHazards();
+        auto kept = std::partition(retired.begin(), retired.end(), [this, &hazards](const Retired& entry) {
+            return entry.domain_ != this || std::binary_search(hazards.begin(), hazards.end(), entry.ptr_);
+        });
+        std::vector<Retired> reclaimable(kept, retired.end());
+        retired.erase(kept, retired.end());
+        for (const Retired& entry : reclaimable) {
+            entry.deleter_(entry.ptr_);
+        }
+    }
+
+    void ScanLocal(RetireList& list) {
+        Scan(list.retired_);
+        list.next_scan_ = list.retired_.size() + kRetireThreshold;
+    }
+
+public:
+    HazardDomain() = default;
+
+    HazardDomain(const HazardDomain&) = delete;
+    HazardDomain& operator=(const HazardDomain&) = delete;
+
+    // No reader may be active, and threads that retired into the domain must have exited or
+    // called reclaim(), once the domain is destroyed. Only the orphans are freed here: the
+    // Default() domain dies during static destruction, after this thread's retire list.
+    ~HazardDomain() {
+        for (const Retired& entry : orphans_) {
+            entry.deleter_(entry.ptr_);
+        }
+    }
+
+    static HazardDomain& Default() {
+        static HazardDomain domain;
+        return domain;
+    }
+
+    Slot* AcquireSlot() {
+        for (size_t i = 0; i < kMaxSlots; ++i) {
+            bool expected = false;
+            if (!slots_[i].in_use_.load(std::memory_order_relaxed) &&
+                slots_[i].in_use_.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                size_t used = slots_used_.load(std::memory_order_relaxed);
+                while (used < i + 1 && !slots_used_.compare_exchange_weak(used, i + 1, std::memory_order_release)) {
+                }
+                return &slots_[i];
+            }
+        }
+        throw std::runtime_error("HazardDomain: all hazard slots are in use");
+    }
+
+    void ReleaseSlot(Slot* slot) noexcept {
+        slot->ptr_.store(nullptr, std::memory_order_release);
+        slot->in_use_.store(false, std::memory_order_release);
+    }
+
+    template <typename T>
+    void retire(T* ptr) {
+        retire(ptr, [](void* object) { delete static_cast<T*>(object); });
+    }
+
+    void retire(void* ptr, void (*deleter)(void*)) {
+        RetireList& list = LocalRetireList();
+        list.retired_.push_back({this, ptr, deleter});
+        if (list.retired_.size() >= list.next_scan_) {
+            ScanLocal(list);
+        }
+    }
+
+    // Frees everything that is no longer protected, including objects left behind by exited threads
+    void reclaim() {
+        ScanLocal(LocalRetireList());
+
+        std::vector<Retired> orphans;
+        {
+            std::lock_guard<std::mutex> lock(orphans_mutex_);
+            orphans.swap(orphans_);
+        }
+        Scan(orphans);
+        if (!orphans.empty()) {
+            std::lock_guard<std::mutex> lock(orphans_mutex_);
+            orphans_.insert(orphans_.end(), orphans.begin(), orphans.end());
+        }
+    }
+};
+
+
+// Owns one hazard slot; keep it around (e.g. thread_local) rather than creating one per read
+class HazardPointer {
+private:
+    HazardDomain* domain_;
+    HazardDomain::Slot* slot_;
+
+public:
+    explicit HazardPointer(HazardDomain& domain = HazardDomain::Default()) : domain_(&domain), slot_(domain.AcquireSlot()) {}
+
+    HazardPointer(const HazardPointer&) = delete;
+    HazardPointer& operator=(const HazardPointer&) = delete;
+
+    ~HazardPointer() {
+        domain_->ReleaseSlot(slot_);
+    }
+
+    // Returns a pointer loaded from source that stays valid until the protection is reset
+    template <typename T>
+    T* protect(const std::atomic<T*>& source) noexcept {
+        T* ptr = source.load(std::memory_order_relaxed);
+        while (true) {
+            // Both seq_cst, so the store cannot pass the reload and the pair orders against
+            // the fence in CollectHazards
+            slot_->ptr_.store(ptr, std::memory_order_seq_cst);
+            T* current = source.load(std::memory_order_seq_cst);
+            if (current == ptr) {
+                return ptr;
+            }
+            ptr = current;
+        }
+    }
+
+    void reset_protection() noexcept {
+        slot_->ptr_.store(nullptr, std::memory_order_release);
+    }
+};
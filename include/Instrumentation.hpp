@@ -0,0 +1,223 @@
+#pragma once
+
+// Opt-in counters for control blocks, reference counts and owned objects. Build with
+// SMARTPTR_INSTRUMENTATION defined (cmake -DSMARTPTR_INSTRUMENTATION=ON) to enable them;
+// otherwise every hook expands to nothing. All translation units of a program must agree
+// on the switch, since it changes the inline bodies of the smart pointers.
+#ifdef SMARTPTR_INSTRUMENTATION
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <vector>
+#include "TypeName.hpp"
+
+class Instrumentation {
+public:
+    enum class Event : size_t {
+        BlocksCreated,
+        BlocksDestroyed,
+        SeparateAllocations,
+        InplaceAllocations,
+        SharedIncrements,
+        SharedDecrements,
+        WeakIncrements,
+        WeakDecrements,
+        Locks,
+        LockFailures,
+        UniqueAcquired,
+        UniqueReleased,
+        Count
+    };
+
+    static constexpr size_t kEventCount = static_cast<size_t>(Event::Count);
+
+    struct Snapshot {
+        std::array<uint64_t, kEventCount> counts_{};
+
+        uint64_t operator[](Event event) const noexcept {
+            return counts_[static_cast<size_t>(event)];
+        }
+    };
+
+    struct LiveCount {
+        std::string type_name_;
+        int64_t live_;
+    };
+
+private:
+    // Written only by the owning thread, so counting is a relaxed load and store; the shared
+    // overflow set is the exception and uses fetch_add
+    struct ThreadCounters {
+        std::array<std::atomic<uint64_t>, kEventCount> counts_{};
+    };
+
+    struct TypeEntry {
+        const std::type_info* type_;
+        std::atomic<int64_t> live_{0};
+    };
+
+    struct Registry {
+        std::mutex mutex_;
+        std::vector<ThreadCounters*> threads_;
+        std::array<uint64_t, kEventCount> retired_{};
+        std::vector<TypeEntry*> types_;
+    };
+
+    // Never destroyed, so threads and objects that outlive static destruction can still report
+    static Registry& GetRegistry() {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    // Plain pointer and flag, so hooks that run during or after thread exit (thread_local
+    // destructors, late static releases) never touch a destroyed object
+    static inline thread_local ThreadCounters* local_ = nullptr;
+    static inline thread_local bool exited_ = false;
+
+    // Shared by threads that have exited or could not register, so their counts still add up
+    static ThreadCounters& Overflow() noexcept {
+        static ThreadCounters overflow;
+        return overflow;
+    }
+
+    // Folds the thread's totals into the registry when the thread exits
+    struct ThreadRetirer {
+        ~ThreadRetirer() {
+            ThreadCounters* counters = local_;
+            local_ = nullptr;
+            exited_ = true;
+            Registry& registry = GetRegistry();
+            {
+                std::lock_guard<std::mutex> lock(registry.mutex_);
+                for (size_t i = 0; i < kEventCount; ++i) {
+                    registry.retired_[i] += counters->counts_[i].load(std::memory_order_relaxed);
+                }
+                std::erase(registry.threads_, counters);
+            }
+            delete counters;
+        }
+    };
+
+    // Null if the thread has exited or registering it failed; never throws, since the hooks
+    // run inside noexcept code
+    static ThreadCounters* Local() noexcept {
+        if (local_ == nullptr && !exited_) {
+            ThreadCounters* counters = new (std::nothrow) ThreadCounters();
+            if (counters == nullptr) {
+                return nullptr;
+            }
+            try {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex_);
+                registry.threads_.push_back(counters);
+            }
+            catch (...) {
+                delete counters;
+                return nullptr;
+            }
+            local_ = counters;
+            static thread_local ThreadRetirer retirer;
+        }
+        return local_;
+    }
+
+    // Null if registering the type failed; such a type is left out of the live report
+    template <typename T>
+    static TypeEntry* Type() noexcept {
+        static TypeEntry* entry = []() noexcept -> TypeEntry* {
+            TypeEntry* created = new (std::nothrow) TypeEntry{&typeid(T)};
+            if (created == nullptr) {
+                return nullptr;
+            }
+            try {
+                Registry& registry = GetRegistry();
+                std::lock_guard<std::mutex> lock(registry.mutex_);
+                registry.types_.push_back(created);
+            }
+            catch (...) {
+                delete created;
+                return nullptr;
+            }
+            return created;
+        }();
+        return entry;
+    }
+
+public:
+    static void Count(Event event) noexcept {
+        size_t index = static_cast<size_t>(event);
+        if (ThreadCounters* local = Local()) {
+            std::atomic<uint64_t>& counter = local->counts_[index];
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        else {
+            Overflow().counts_[index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    template <typename T>
+    static void TrackLive(int64_t delta) noexcept {
+        if (TypeEntry* entry = Type<T>()) {
+            entry->live_.fetch_add(delta, std::memory_order_relaxed);
+        }
+    }
+
+    // Sums the counters of exited threads and of every thread still running
+    static Snapshot Collect() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        Snapshot snapshot;
+        snapshot.counts_ = registry.retired_;
+        for (size_t i = 0; i < kEventCount; ++i) {
+            snapshot.counts_[i] += Overflow().counts_[i].load(std::memory_order_relaxed);
+        }
+        for (ThreadCounters* thread : registry.threads_) {
+            for (size_t i = 0; i < kEventCount; ++i) {
+                snapshot.counts_[i] += thread->counts_[i].load(std::memory_order_relaxed);
+            }
+        }
+        return snapshot;
+    }
+
+    // Objects currently owned by a control block or a UniquePtr, per type
+    static std::vector<LiveCount> LiveObjects() {
+        std::vector<std::pair<const std::type_info*, int64_t>> raw;
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex_);
+            for (TypeEntry* entry : registry.types_) {
+                raw.emplace_back(entry->type_, entry->live_.load(std::memory_order_relaxed));
+            }
+        }
+        std::vector<LiveCount> live;
+        for (const auto& [type, count] : raw) {
+            if (count != 0) {
+                live.push_back(LiveCount{DemangledTypeName(*type), count});
+            }
+        }
+        return live;
+    }
+
+    static void DumpLiveObjects(std::ostream& out) {
+        for (const LiveCount& entry : LiveObjects()) {
+            out << entry.type_name_ << ": " << entry.live_ << "\n";
+        }
+    }
+};
+
+#define SMARTPTR_COUNT(event) Instrumentation::Count(Instrumentation::Event::event)
+#define SMARTPTR_TRACK_LIVE(T, delta) Instrumentation::TrackLive<T>(delta)
+
+#else
+
+#define SMARTPTR_COUNT(event) ((void)0)
+#define SMARTPTR_TRACK_LIVE(T, delta) ((void)0)
+
+#endif
@@ -0,0 +1,168 @@
+#pragma once
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include "RefCountPolicy.hpp"
+#include "TriviallyRelocatable.hpp"
+#include "UniquePtr.hpp"
+
+// CRTP base that embeds the reference count in the object itself
+template <typename Derived, typename Policy = NonAtomicPolicy>
+class RefCounted {
+private:
+    mutable typename Policy::Counter ref_counter_;
+
+protected:
+    RefCounted() noexcept : ref_counter_(0) {}
+
+    // A copy is a new object, it does not inherit the owners of the original
+    RefCounted(const RefCounted&) noexcept : ref_counter_(0) {}
+
+    RefCounted& operator=(const RefCounted&) noexcept {
+        return *this;
+    }
+
+    ~RefCounted() = default;
+
+public:
+    void AddRef() const noexcept {
+        ref_counter_.Increment();
+    }
+
+    void ReleaseRef() const noexcept {
+        if (ref_counter_.Decrement()) {
+            delete static_cast<const Derived*>(this);
+        }
+    }
+
+    size_t RefCount() const noexcept {
+        return ref_counter_.Load();
+    }
+};
+
+
+// One-word owning pointer for types deriving from RefCounted
+template <typename T>
+class IntrusivePtr {
+private:
+    T* ptr_;
+
+public:
+    constexpr IntrusivePtr() noexcept : ptr_(nullptr) {}
+
+    constexpr IntrusivePtr(std::nullptr_t) noexcept : ptr_(nullptr) {}
+
+    // add_ref = false adopts a reference the caller already owns
+    explicit IntrusivePtr(T* ptr, bool add_ref = true) noexcept : ptr_(ptr) {
+        if (ptr_ && add_ref) {
+            ptr_->AddRef();
+        }
+    }
+
+    // Takes over the object of a UniquePtr without reallocating it
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    explicit IntrusivePtr(UniquePtr<U>&& unique) noexcept : ptr_(unique.release()) {
+        if (ptr_) {
+            ptr_->AddRef();
+        }
+    }
+
+    IntrusivePtr(const IntrusivePtr& other) noexcept : ptr_(other.ptr_) {
+        if (ptr_) {
+            ptr_->AddRef();
+        }
+    }
+
+    IntrusivePtr(IntrusivePtr&& other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    // SFINAE
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePtr(const IntrusivePtr<U>& other) noexcept : ptr_(other.ptr_) {
+        if (ptr_) {
+            ptr_->AddRef();
+        }
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    IntrusivePtr(IntrusivePtr<U>&& other) noexcept : ptr_(other.ptr_) {
+        other.ptr_ = nullptr;
+    }
+
+    ~IntrusivePtr() {
+        if (ptr_) {
+            ptr_->ReleaseRef();
+        }
+    }
+
+    IntrusivePtr& operator=(const IntrusivePtr& other) noexcept {
+        IntrusivePtr(other).swap(*this);
+        return *this;
+    }
+
+    IntrusivePtr& operator=(IntrusivePtr&& other) noexcept {
+        IntrusivePtr(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    const T* get() const noexcept {
+        return ptr_;
+    }
+
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    T& operator*() const {
+        if (ptr_ == nullptr) {
+            throw std::runtime_error("Dereferencing a nullptr");
+        }
+        return *ptr_;
+    }
+
+    T* operator->() const noexcept {
+        return ptr_;
+    }
+
+    size_t use_count() const noexcept {
+        return ptr_ ? ptr_->RefCount() : 0;
+    }
+
+    void reset(T* new_ptr = nullptr) noexcept {
+        IntrusivePtr(new_ptr).swap(*this);
+    }
+
+    // Gives up ownership without touching the count; pair with IntrusivePtr(ptr, false)
+    T* release() noexcept {
+        T* tmp = ptr_;
+        ptr_ = nullptr;
+        return tmp;
+    }
+
+    void swap(IntrusivePtr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+    }
+
+    bool operator==(const IntrusivePtr& other) const noexcept {
+        return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(const IntrusivePtr& other) const noexcept {
+        return ptr_ != other.ptr_;
+    }
+
+    template <typename U>
+    friend class IntrusivePtr;
+};
+
+
+template <typename T>
+struct IsTriviallyRelocatable<IntrusivePtr<T>> : std::true_type {};
+
+
+template <typename T, typename... Args>
+IntrusivePtr<T> make_intrusive(Args&&... args) {
+    return IntrusivePtr<T>(new T(std::forward<Args>(args)...));
+}
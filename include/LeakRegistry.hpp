@@ -0,0 +1,245 @@
+#pragma once
+
+// Debug registry of live control blocks, with a leak report and a trial-deletion cycle
+// collector. Build with SMARTPTR_DEBUG_REGISTRY defined (cmake -DSMARTPTR_DEBUG_REGISTRY=ON)
+// to enable it; otherwise the hooks expand to nothing. As with instrumentation, every
+// translation unit of a program must agree on the switch.
+#ifdef SMARTPTR_DEBUG_REGISTRY
+
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "TypeName.hpp"
+
+template <typename T, typename Policy>
+class SharedPtr;
+
+class LeakRegistry {
+public:
+    // Passed to T::TraceRefs(visitor); the object calls visitor(member) for every SharedPtr it owns
+    class Visitor {
+    private:
+        std::vector<const void*> children_;
+
+        friend class LeakRegistry;
+
+    public:
+        template <typename U, typename P>
+        void operator()(const SharedPtr<U, P>& ref) {
+            if (const void* block = LeakRegistry::BlockOf(ref)) {
+                children_.push_back(block);
+            }
+        }
+    };
+
+    struct LiveBlock {
+        std::string type_name_;
+        const void* object_;
+        size_t use_count_;
+    };
+
+private:
+    // Type-erased access to a BasicControlBlock<Policy>
+    struct BlockOps {
+        size_t (*shared_count_)(const void* block);
+        void (*hold_)(void* block);
+        void (*dispose_)(void* block);
+        void (*drop_disposed_)(void* block);
+    };
+
+    struct Entry {
+        const BlockOps* ops_ = nullptr;
+        const std::type_info* type_ = nullptr;
+        const void* object_ = nullptr;
+        void (*trace_)(const void* object, Visitor& visitor) = nullptr;
+    };
+
+    struct Registry {
+        std::mutex mutex_;
+        std::unordered_map<const void*, Entry> blocks_;
+    };
+
+    // Never destroyed, so blocks released during static destruction can still unregister
+    static Registry& GetRegistry() {
+        static Registry* registry = new Registry();
+        return *registry;
+    }
+
+    template <typename Block>
+    static const BlockOps* OpsFor() {
+        static constexpr BlockOps ops{
+            [](const void* block) { return static_cast<const Block*>(block)->SharedCount(); },
+            [](void* block) { static_cast<Block*>(block)->IncrementShared(); },
+            [](void* block) { static_cast<Block*>(block)->DisposeObject(); },
+            [](void* block) { static_cast<Block*>(block)->ReleaseDisposed(); },
+        };
+        return &ops;
+    }
+
+    template <typename U, typename P>
+    static const void* BlockOf(const SharedPtr<U, P>& ref) noexcept {
+        return ref.ref_counter_;
+    }
+
+public:
+    template <typename Block>
+    static void Register(Block* block) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        registry.blocks_[block].ops_ = OpsFor<Block>();
+    }
+
+    static void Unregister(const void* block) noexcept {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        registry.blocks_.erase(block);
+    }
+
+    // Called by the typed control blocks once they know the object; T::TraceRefs is optional
+    template <typename T>
+    static void Describe(const void* block, const T* object) {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        Entry& entry = registry.blocks_[block];
+        entry.type_ = &typeid(T);
+        entry.object_ = object;
+        if constexpr (requires(const T& traced, Visitor& visitor) { traced.TraceRefs(visitor); }) {
+            entry.trace_ = [](const void* traced, Visitor& visitor) {
+                static_cast<const T*>(traced)->TraceRefs(visitor);
+            };
+        }
+    }
+
+    // Blocks whose object is still alive
+    static std::vector<LiveBlock> LiveBlocks() {
+        Registry& registry = GetRegistry();
+        std::lock_guard<std::mutex> lock(registry.mutex_);
+        std::vector<LiveBlock> live;
+        for (const auto& [block, entry] : registry.blocks_) {
+            size_t count = entry.ops_->shared_count_(block);
+            if (count > 0) {
+                live.push_back(LiveBlock{entry.type_ ? DemangledTypeName(*entry.type_) : "<unknown>", entry.object_, count});
+            }
+        }
+        return live;
+    }
+
+    static size_t Report(std::ostream& out) {
+        std::vector<LiveBlock> live = LiveBlocks();
+        for (const LiveBlock& block : live) {
+            out << "live " << block.type_name_ << " at " << block.object_ << " (use_count " << block.use_count_ << ")\n";
+        }
+        return live.size();
+    }
+
+    // Prints whatever is still alive when the program exits. Call it early in main, so the
+    // report runs after the destructors of statics constructed later.
+    static void ReportAtExit() {
+        std::atexit([] {
+            if (!LiveBlocks().empty()) {
+                std::cerr << "SharedPtr objects alive at exit:\n";
+                Report(std::cerr);
+            }
+        });
+    }
+
+    // Trial deletion: subtract the references that traced objects hold to each other; blocks
+    // left at zero are reachable only from inside the graph unless a root still reaches them.
+    // The rest is garbage (cycles and whatever hangs off them) and is destroyed. References held
+    // by objects without TraceRefs are invisible, so their targets always survive. Call it while
+    // no other thread is changing the traced pointers. Returns the number of objects destroyed.
+    static size_t CollectCycles() {
+        std::vector<std::pair<void*, const BlockOps*>> garbage;
+        {
+            Registry& registry = GetRegistry();
+            std::lock_guard<std::mutex> lock(registry.mutex_);
+
+            struct Node {
+                void* block_;
+                const Entry* entry_;
+                size_t trial_count_;
+                std::vector<size_t> children_;
+                bool reachable_ = false;
+            };
+
+            std::vector<Node> nodes;
+            std::unordered_map<const void*, size_t> index;
+            for (const auto& [block, entry] : registry.blocks_) {
+                size_t count = entry.ops_->shared_count_(block);
+                if (count > 0) {
+                    index.emplace(block, nodes.size());
+                    nodes.push_back(Node{const_cast<void*>(block), &entry, count, {}});
+                }
+            }
+
+            for (Node& node : nodes) {
+                if (!node.entry_->trace_) {
+                    continue;
+                }
+                Visitor visitor;
+                node.entry_->trace_(node.entry_->object_, visitor);
+                for (const void* child : visitor.children_) {
+                    auto it = index.find(child);
+                    if (it != index.end()) {
+                        node.children_.push_back(it->second);
+                        --nodes[it->second].trial_count_;
+                    }
+                }
+            }
+
+            std::vector<size_t> pending;
+            for (size_t i = 0; i < nodes.size(); ++i) {
+                if (nodes[i].trial_count_ > 0) {
+                    nodes[i].reachable_ = true;
+                    pending.push_back(i);
+                }
+            }
+            while (!pending.empty()) {
+                size_t current = pending.back();
+                pending.pop_back();
+                for (size_t child : nodes[current].children_) {
+                    if (!nodes[child].reachable_) {
+                        nodes[child].reachable_ = true;
+                        pending.push_back(child);
+                    }
+                }
+            }
+
+            // Our own strong reference keeps every garbage block alive until all are disposed
+            for (Node& node : nodes) {
+                if (!node.reachable_) {
+                    node.entry_->ops_->hold_(node.block_);
+                    garbage.emplace_back(node.block_, node.entry_->ops_);
+                }
+            }
+        }
+
+        // Outside the lock: destroying objects unregisters the blocks they release
+        for (const auto& [block, ops] : garbage) {
+            ops->dispose_(block);
+        }
+        for (const auto& [block, ops] : garbage) {
+            ops->drop_disposed_(block);
+        }
+        return garbage.size();
+    }
+};
+
+#define SMARTPTR_REGISTER_BLOCK(block) LeakRegistry::Register(block)
+#define SMARTPTR_UNREGISTER_BLOCK(block) LeakRegistry::Unregister(block)
+#define SMARTPTR_DESCRIBE_BLOCK(block, object) LeakRegistry::Describe(block, object)
+
+#else
+
+#define SMARTPTR_REGISTER_BLOCK(block) ((void)0)
+#define SMARTPTR_UNREGISTER_BLOCK(block) ((void)0)
+#define SMARTPTR_DESCRIBE_BLOCK(block, object) ((void)0)
+
+#endif
@@ -0,0 +1,188 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+#include "SharedPtr.hpp"
+#include "UniquePtr.hpp"
+
+// Recycles objects instead of deleting them. Pointers handed out by acquire() and
+// acquire_unique() return their object to the pool on last release; the reset hook puts it
+// back into a reusable state while it keeps whatever capacity its members have grown, so a
+// later acquire() skips the constructor and the allocations it would make. Objects may be
+// released from any thread and may outlive the pool, in which case they are deleted.
+template <typename T, typename Policy = NonAtomicPolicy>
+class ObjectPool {
+private:
+    // Shared with every object out of the pool, so late releases still find it
+    struct State {
+        std::mutex mutex_;
+        std::vector<T*> idle_;
+        std::function<T*()> create_;
+        std::function<void(T&)> reset_;
+        size_t max_idle_;
+        bool closed_ = false;
+        // The pool itself plus one per object handed out
+        std::atomic<size_t> refs_{1};
+
+        State(std::function<T*()> create, std::function<void(T&)> reset, size_t max_idle)
+            : create_(std::move(create)), reset_(std::move(reset)), max_idle_(max_idle) {}
+
+        ~State() {
+            for (T* object : idle_) {
+                delete object;
+            }
+        }
+
+        void Release() noexcept {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+        // A throwing reset hook costs the object, not the program
+        void Recycle(T* object) noexcept {
+            bool keep = true;
+            if (reset_) {
+                try {
+                    reset_(*object);
+                }
+                catch (...) {
+                    keep = false;
+                }
+            }
+            if (keep) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                if (!closed_ && idle_.size() < max_idle_) {
+                    idle_.push_back(object);
+                    object = nullptr;
+                }
+            }
+            delete object;
+            Release();
+        }
+    };
+
+    State* state_;
+
+public:
+    // Used by both pointer kinds; a default-constructed one simply deletes
+    class Deleter {
+    private:
+        State* state_;
+
+        explicit Deleter(State* state) noexcept : state_(state) {}
+
+        friend class ObjectPool;
+
+    public:
+        Deleter() noexcept : state_(nullptr) {}
+
+        void operator()(T* object) const noexcept {
+            if (state_) {
+                state_->Recycle(object);
+            }
+            else {
+                delete object;
+            }
+        }
+    };
+
+    using Shared = SharedPtr<T, Policy>;
+    using Unique = UniquePtr<T, Deleter>;
+
+    explicit ObjectPool(std::function<T*()> create = [] { return new T(); }, std::function<void(T&)> reset = {},
+                        size_t max_idle = SIZE_MAX)
+        : state_(new State(std::move(create), std::move(reset), max_idle)) {}
+
+    ObjectPool(const ObjectPool&) = delete;
+    ObjectPool& operator=(const ObjectPool&) = delete;
+
+    // Idle objects go now, objects still out are deleted when they come back
+    ~ObjectPool() {
+        std::vector<T*> idle;
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            state_->closed_ = true;
+            idle.swap(state_->idle_);
+        }
+        for (T* object : idle) {
+            delete object;
+        }
+        state_->Release();
+    }
+
+    Shared acquire() {
+        return Shared(Take(), Deleter(state_));
+    }
+
+    Unique acquire_unique() {
+        return Unique(Take(), Deleter(state_));
+    }
+
+    // Creates objects up front so the first acquires are recycled ones too; never fills the
+    // pool beyond max_idle
+    void reserve(size_t count) {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            count = std::min(count, state_->max_idle_ - std::min(state_->idle_.size(), state_->max_idle_));
+        }
+        std::vector<T*> created;
+        created.reserve(count);
+        try {
+            while (created.size() < count) {
+                created.push_back(Create());
+            }
+            // Concurrent releases may have filled the pool meanwhile
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            size_t room = state_->max_idle_ - std::min(state_->idle_.size(), state_->max_idle_);
+            size_t kept = std::min(room, created.size());
+            state_->idle_.insert(state_->idle_.end(), created.begin(), created.begin() + kept);
+            created.erase(created.begin(), created.begin() + kept);
+        }
+        catch (...) {
+            for (T* object : created) {
+                delete object;
+            }
+            throw;
+        }
+        for (T* object : created) {
+            delete object;
+        }
+    }
+
+    size_t idle() const {
+        std::lock_guard<std::mutex> lock(state_->mutex_);
+        return state_->idle_.size();
+    }
+
+private:
+    // A factory that yields null has failed to allocate
+    T* Create() {
+        T* object = state_->create_();
+        if (object == nullptr) {
+            throw std::bad_alloc();
+        }
+        return object;
+    }
+
+    T* Take() {
+        {
+            std::lock_guard<std::mutex> lock(state_->mutex_);
+            if (!state_->idle_.empty()) {
+                T* object = state_->idle_.back();
+                state_->idle_.pop_back();
+                state_->refs_.fetch_add(1, std::memory_order_relaxed);
+                return object;
+            }
+        }
+        T* object = Create();
+        state_->refs_.fetch_add(1, std::memory_order_relaxed);
+        return object;
+    }
+};
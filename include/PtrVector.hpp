@@ -0,0 +1,196 @@
+#pragma once
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <utility>
+#include "TriviallyRelocatable.hpp"
+
+// Vector for trivially relocatable elements such as the smart pointers of this library.
+// Growth and erase move elements with memcpy/memmove instead of a move-construct and a
+// destroy per element, so reallocating millions of pointers is a single bulk copy.
+template <typename P>
+class PtrVector {
+    static_assert(is_trivially_relocatable_v<P>, "PtrVector needs a trivially relocatable element type");
+
+private:
+    P* data_;
+    size_t size_;
+    size_t capacity_;
+
+    static P* Allocate(size_t capacity) {
+        return std::allocator<P>().allocate(capacity);
+    }
+
+    static void Deallocate(P* data, size_t capacity) noexcept {
+        if (data) {
+            std::allocator<P>().deallocate(data, capacity);
+        }
+    }
+
+    // Bitwise relocation: the old buffer is freed without running destructors
+    void Relocate(P* new_data, size_t new_capacity) noexcept {
+        if (size_ > 0) {
+            std::memcpy(static_cast<void*>(new_data), static_cast<const void*>(data_), size_ * sizeof(P));
+        }
+        Deallocate(data_, capacity_);
+        data_ = new_data;
+        capacity_ = new_capacity;
+    }
+
+    size_t GrownCapacity() const noexcept {
+        return capacity_ ? capacity_ * 2 : 4;
+    }
+
+public:
+    using value_type = P;
+    using iterator = P*;
+    using const_iterator = const P*;
+
+    PtrVector() noexcept : data_(nullptr), size_(0), capacity_(0) {}
+
+    PtrVector(const PtrVector& other) : data_(nullptr), size_(0), capacity_(0) {
+        reserve(other.size_);
+        for (const P& element : other) {
+            push_back(element);
+        }
+    }
+
+    PtrVector(PtrVector&& other) noexcept : data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+        other.data_ = nullptr;
+        other.size_ = 0;
+        other.capacity_ = 0;
+    }
+
+    ~PtrVector() {
+        clear();
+        Deallocate(data_, capacity_);
+    }
+
+    PtrVector& operator=(const PtrVector& other) {
+        PtrVector(other).swap(*this);
+        return *this;
+    }
+
+    PtrVector& operator=(PtrVector&& other) noexcept {
+        PtrVector(std::move(other)).swap(*this);
+        return *this;
+    }
+
+    void reserve(size_t capacity) {
+        if (capacity > capacity_) {
+            Relocate(Allocate(capacity), capacity);
+        }
+    }
+
+    // The new element is built in the new buffer before the old ones move, so args may
+    // refer to an element of this vector and a throwing constructor leaves it untouched
+    template <typename... Args>
+    P& emplace_back(Args&&... args) {
+        if (size_ < capacity_) {
+            ::new (static_cast<void*>(data_ + size_)) P(std::forward<Args>(args)...);
+            return data_[size_++];
+        }
+
+        size_t new_capacity = GrownCapacity();
+        P* new_data = Allocate(new_capacity);
+        try {
+            ::new (static_cast<void*>(new_data + size_)) P(std::forward<Args>(args)...);
+        }
+        catch (...) {
+            Deallocate(new_data, new_capacity);
+            throw;
+        }
+        Relocate(new_data, new_capacity);
+        return data_[size_++];
+    }
+
+    void push_back(const P& value) {
+        emplace_back(value);
+    }
+
+    void push_back(P&& value) {
+        emplace_back(std::move(value));
+    }
+
+    void pop_back() noexcept {
+        data_[--size_].~P();
+    }
+
+    // The tail slides down over the erased range with one memmove
+    iterator erase(const_iterator first, const_iterator last) noexcept {
+        P* begin = data_ + (first - data_);
+        P* end = data_ + (last - data_);
+        std::destroy(begin, end);
+        size_t tail = static_cast<size_t>(data_ + size_ - end);
+        if (tail > 0) {
+            std::memmove(static_cast<void*>(begin), static_cast<const void*>(end), tail * sizeof(P));
+        }
+        size_ -= static_cast<size_t>(end - begin);
+        return begin;
+    }
+
+    iterator erase(const_iterator position) noexcept {
+        return erase(position, position + 1);
+    }
+
+    void resize(size_t size) {
+        if (size < size_) {
+            erase(data_ + size, data_ + size_);
+            return;
+        }
+        reserve(size);
+        while (size_ < size) {
+            ::new (static_cast<void*>(data_ + size_)) P();
+            ++size_;
+        }
+    }
+
+    void clear() noexcept {
+        std::destroy(data_, data_ + size_);
+        size_ = 0;
+    }
+
+    void swap(PtrVector& other) noexcept {
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    P& operator[](size_t index) noexcept {
+        return data_[index];
+    }
+
+    const P& operator[](size_t index) const noexcept {
+        return data_[index];
+    }
+
+    P& at(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("PtrVector index out of range");
+        }
+        return data_[index];
+    }
+
+    P& back() noexcept {
+        return data_[size_ - 1];
+    }
+
+    iterator begin() noexcept { return data_; }
+    iterator end() noexcept { return data_ + size_; }
+    const_iterator begin() const noexcept { return data_; }
+    const_iterator end() const noexcept { return data_ + size_; }
+
+    size_t size() const noexcept {
+        return size_;
+    }
+
+    size_t capacity() const noexcept {
+        return capacity_;
+    }
+
+    bool empty() const noexcept {
+        return size_ == 0;
+    }
+};
@@ -0,0 +1,495 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Reference counting policies for ControlBlock. A policy exposes a Counter type with
+// Increment(), Decrement() (returns true when the count drops to zero),
+// IncrementIfNonZero() (used by WeakPtr::lock), Load(), and the bulk forms Add(n) and
+// Sub(n) used by SharedPtr::share_n and release_all. A policy may also name a separate
+// WeakCounter type for the weak count; otherwise Counter is used for both.
+
+// Plain counters, for pointers that never cross a thread boundary
+struct NonAtomicPolicy {
+    class Counter {
+    private:
+        size_t value_;
+
+    public:
+        explicit Counter(size_t value) noexcept : value_(value) {}
+
+        void Increment() noexcept {
+            ++value_;
+        }
+
+        bool Decrement() noexcept {
+            return --value_ == 0;
+        }
+
+        void Add(size_t n) noexcept {
+            value_ += n;
+        }
+
+        bool Sub(size_t n) noexcept {
+            value_ -= n;
+            return value_ == 0;
+        }
+
+        bool IncrementIfNonZero() noexcept {
+            if (value_ == 0) {
+                return false;
+            }
+            ++value_;
+            return true;
+        }
+
+        size_t Load() const noexcept {
+            return value_;
+        }
+    };
+};
+
+
+// Atomic counters, safe to share between threads
+struct AtomicPolicy {
+    class Counter {
+    private:
+        std::atomic<size_t> value_;
+
+    public:
+        explicit Counter(size_t value) noexcept : value_(value) {}
+
+        // A new reference is always made from an existing one, so no ordering is needed here
+        void Increment() noexcept {
+            value_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        // acq_rel: every write made through other references happens-before the destruction
+        bool Decrement() noexcept {
+            return value_.fetch_sub(1, std::memory_order_acq_rel) == 1;
+        }
+
+        void Add(size_t n) noexcept {
+            value_.fetch_add(n, std::memory_order_relaxed);
+        }
+
+        bool Sub(size_t n) noexcept {
+            return value_.fetch_sub(n, std::memory_order_acq_rel) == n;
+        }
+
+        // Never resurrects a count that already reached zero; retries only when another thread raced us
+        bool IncrementIfNonZero() noexcept {
+            size_t value = value_.load(std::memory_order_relaxed);
+            while (value != 0) {
+                if (value_.compare_exchange_weak(value, value + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        size_t Load() const noexcept {
+            return value_.load(std::memory_order_acquire);
+        }
+    };
+};
+
+
+// Biased reference counting. The thread that creates a counter (its owner) updates its own
+// share with plain loads and stores; every other thread uses an atomic secondary count,
+// which may go negative when an owner-made reference is dropped elsewhere. A thread whose
+// decrement leaves the secondary count negative pins the counter and queues it for the owner,
+// which merges both counts on its next count update or new counter (or when it exits) and,
+// if the total turns out to be zero, runs the handler installed with SetZeroHandler(). An
+// owner that may go quiet for long can call BiasedPolicy::MergeQueued() at safepoints. After
+// the owner drops its last biased reference the counter stays merged and behaves like an
+// AtomicPolicy one.
+struct BiasedPolicy {
+    class Counter;
+
+private:
+    class OwnerState {
+    private:
+        std::atomic<size_t> refs_{1};
+        std::mutex mutex_;
+        bool exited_ = false;
+        std::vector<Counter*> queued_;
+
+    public:
+        std::atomic<bool> has_queued_{false};
+
+        void AddRef() noexcept {
+            refs_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        void Release() noexcept {
+            if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                delete this;
+            }
+        }
+
+        // Returns false once the owner has exited; the caller then merges the counter itself
+        bool Enqueue(Counter* counter) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (exited_) {
+                return false;
+            }
+            queued_.push_back(counter);
+            has_queued_.store(true, std::memory_order_release);
+            return true;
+        }
+
+        // Runs on the owner thread only
+        void Drain() noexcept {
+            std::vector<Counter*> queued;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                queued.swap(queued_);
+                has_queued_.store(false, std::memory_order_relaxed);
+            }
+            for (Counter* counter : queued) {
+                counter->MergeQueued();
+            }
+        }
+
+        void Exit() noexcept {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                exited_ = true;
+            }
+            Drain();
+        }
+    };
+
+    // Trivially destructible, so owner checks on the hot path cost a plain TLS load
+    static inline thread_local OwnerState* current_owner_ = nullptr;
+    static inline thread_local bool owner_exited_ = false;
+
+    struct ThreadOwner {
+        OwnerState* state_ = new OwnerState();
+
+        ThreadOwner() noexcept {
+            current_owner_ = state_;
+        }
+
+        ~ThreadOwner() {
+            current_owner_ = nullptr;
+            owner_exited_ = true;
+            state_->Exit();
+            state_->Release();
+        }
+    };
+
+    static OwnerState* CurrentOwner() {
+        if (current_owner_ == nullptr && !owner_exited_) {
+            static thread_local ThreadOwner owner;
+            (void)owner;
+        }
+        return current_owner_;
+    }
+
+public:
+    // Merges the counters other threads queued for the calling thread; producers that hand
+    // every reference away and never drop one themselves can call it at safepoints
+    static void MergeQueued() noexcept {
+        if (current_owner_ && current_owner_->has_queued_.load(std::memory_order_acquire)) {
+            current_owner_->Drain();
+        }
+    }
+
+    class Counter {
+    private:
+        // Low bits of shared_: merged, queued (and pinned); the rest is a signed count
+        static constexpr intptr_t kMerged = 1;
+        static constexpr intptr_t kQueued = 2;
+        static constexpr intptr_t kOne = 4;
+        static constexpr int kCountShift = 2;
+
+        OwnerState* owner_;
+        std::atomic<size_t> biased_;
+        bool merged_;
+        std::atomic<intptr_t> shared_;
+        void (*on_zero_)(void*) = nullptr;
+        void* context_ = nullptr;
+
+        bool OnOwnerFastPath() const noexcept {
+            return owner_ != nullptr && owner_ == current_owner_ && !merged_;
+        }
+
+        // Folds the biased share into the atomic count and drops the queue pin
+        void MergeQueued() noexcept {
+            size_t biased = merged_ ? 0 : biased_.load(std::memory_order_relaxed);
+            biased_.store(0, std::memory_order_relaxed);
+            merged_ = true;
+
+            intptr_t shared = shared_.load(std::memory_order_relaxed);
+            intptr_t count;
+            do {
+                count = (shared >> kCountShift) + static_cast<intptr_t>(biased) - 1;
+            } while (!shared_.compare_exchange_weak(shared, (count << kCountShift) | kMerged, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+            if (count == 0 && on_zero_) {
+                on_zero_(context_);
+            }
+        }
+
+        // The count went negative: only the owner knows its biased share, so it must merge
+        bool HandToOwner() noexcept {
+            intptr_t shared = shared_.load(std::memory_order_relaxed);
+            do {
+                // A merge or an earlier hand-off already covers our decrement
+                if ((shared & (kMerged | kQueued)) || (shared >> kCountShift) >= 0) {
+                    return false;
+                }
+            } while (!shared_.compare_exchange_weak(shared, (shared + kOne) | kQueued, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+            if (owner_->Enqueue(this)) {
+                return false;
+            }
+
+            // The owner has exited, so its biased share is frozen and we may merge it here
+            size_t biased = biased_.load(std::memory_order_acquire);
+            merged_ = true;
+            shared = shared_.load(std::memory_order_relaxed);
+            intptr_t count;
+            do {
+                count = (shared >> kCountShift) + static_cast<intptr_t>(biased) - 1;
+            } while (!shared_.compare_exchange_weak(shared, (count << kCountShift) | kMerged, std::memory_order_acq_rel, std::memory_order_relaxed));
+            return count == 0;
+        }
+
+        // Biased share plus atomic count, less the queue pin; after a merge biased_ is zero
+        intptr_t LogicalCount(intptr_t shared) const noexcept {
+            intptr_t count = (shared >> kCountShift) - ((shared & kQueued) ? 1 : 0);
+            return static_cast<intptr_t>(biased_.load(std::memory_order_acquire)) + count;
+        }
+
+        friend class OwnerState;
+
+    public:
+        // A counter that starts at zero has no owner references to bias, so it starts merged
+        explicit Counter(size_t value)
+            : owner_(value ? CurrentOwner() : nullptr),
+              biased_(owner_ ? value : 0),
+              merged_(owner_ == nullptr),
+              shared_(owner_ ? 0 : (static_cast<intptr_t>(value) << kCountShift) | kMerged) {
+            if (owner_) {
+                owner_->AddRef();
+                BiasedPolicy::MergeQueued();
+            }
+        }
+
+        Counter(const Counter&) = delete;
+        Counter& operator=(const Counter&) = delete;
+
+        ~Counter() {
+            if (owner_) {
+                owner_->Release();
+            }
+        }
+
+        // Called when a queued merge finds the count at zero
+        void SetZeroHandler(void (*on_zero)(void*), void* context) noexcept {
+            on_zero_ = on_zero;
+            context_ = context;
+        }
+
+        void Increment() noexcept {
+            Add(1);
+        }
+
+        bool Decrement() noexcept {
+            return Sub(1);
+        }
+
+        void Add(size_t n) noexcept {
+            if (OnOwnerFastPath() && owner_->has_queued_.load(std::memory_order_acquire)) {
+                owner_->Drain();
+            }
+            if (OnOwnerFastPath()) {
+                biased_.store(biased_.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+                return;
+            }
+            shared_.fetch_add(static_cast<intptr_t>(n) * kOne, std::memory_order_relaxed);
+        }
+
+        bool Sub(size_t n) noexcept {
+            if (OnOwnerFastPath() && owner_->has_queued_.load(std::memory_order_acquire)) {
+                owner_->Drain();
+            }
+            if (OnOwnerFastPath()) {
+                size_t biased = biased_.load(std::memory_order_relaxed);
+                if (n < biased) {
+                    biased_.store(biased - n, std::memory_order_relaxed);
+                    return false;
+                }
+                // The owner's share runs out: merge, charging the remainder to the atomic count
+                biased_.store(0, std::memory_order_relaxed);
+                merged_ = true;
+                intptr_t delta = kMerged - static_cast<intptr_t>(n - biased) * kOne;
+                intptr_t shared = shared_.fetch_add(delta, std::memory_order_acq_rel) + delta;
+                return (shared >> kCountShift) == 0;
+            }
+
+            intptr_t delta = static_cast<intptr_t>(n) * kOne;
+            intptr_t shared = shared_.fetch_sub(delta, std::memory_order_acq_rel) - delta;
+            if (shared & kMerged) {
+                return (shared >> kCountShift) == 0;
+            }
+            if ((shared >> kCountShift) >= 0 || (shared & kQueued)) {
+                return false;
+            }
+            return HandToOwner();
+        }
+
+        // biased_ alone says nothing about liveness: a foreign drop can take the logical count
+        // to zero while the merge is still queued, so both paths check the sum
+        bool IncrementIfNonZero() noexcept {
+            if (OnOwnerFastPath() && owner_->has_queued_.load(std::memory_order_acquire)) {
+                owner_->Drain();
+            }
+            if (OnOwnerFastPath()) {
+                if (LogicalCount(shared_.load(std::memory_order_acquire)) <= 0) {
+                    return false;
+                }
+                biased_.store(biased_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return true;
+            }
+            intptr_t shared = shared_.load(std::memory_order_relaxed);
+            while (true) {
+                if (shared & kMerged) {
+                    if ((shared >> kCountShift) == 0) {
+                        return false;
+                    }
+                }
+                else if (LogicalCount(shared) <= 0) {
+                    return false;
+                }
+                if (shared_.compare_exchange_weak(shared, shared + kOne, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+        }
+
+        size_t Load() const noexcept {
+            return static_cast<size_t>(LogicalCount(shared_.load(std::memory_order_acquire)));
+        }
+    };
+};
+
+
+// Striped counting for a few extremely hot, long-lived objects. Each thread updates one of
+// kSlots counters, each on its own cache line, and a central count holds a large bias that
+// keeps the total away from zero. Nothing can reach zero until Retire() (SharedPtr::retire)
+// closes the slots, folds them into the central count and drops the bias; from then on the
+// counter behaves like an AtomicPolicy one. An object that is never retired is never freed.
+struct StripedPolicy {
+    class Counter {
+    private:
+        static constexpr size_t kSlots = 16;
+        static constexpr size_t kCacheLine = 64;
+        // Slots count in steps of kOne; the low bit marks a slot closed by Retire()
+        static constexpr intptr_t kClosed = 1;
+        static constexpr intptr_t kOne = 2;
+        static constexpr intptr_t kBias = intptr_t{1} << 40;
+
+        struct alignas(kCacheLine) Slot {
+            std::atomic<intptr_t> value_{0};
+        };
+
+        Slot slots_[kSlots];
+        alignas(kCacheLine) std::atomic<intptr_t> central_;
+        std::atomic<bool> retired_{false};
+
+        // Threads take slots round-robin; the index is stored plus one so that the
+        // thread_local needs no dynamic initialisation guard on the hot path
+        static Slot& SlotFor(Slot* slots) noexcept {
+            static std::atomic<size_t> next_slot{0};
+            static thread_local size_t slot = 0;
+            if (slot == 0) [[unlikely]] {
+                slot = next_slot.fetch_add(1, std::memory_order_relaxed) % kSlots + 1;
+            }
+            return slots[slot - 1];
+        }
+
+        // Returns false when the slot is closed and the caller must use the central count.
+        // Retire() never reads a slot again once closed, so a late add to it is harmless.
+        // Release pairs with the acquire in Retire(), which folds the slot.
+        static bool TryAddToSlot(Slot& slot, intptr_t delta) noexcept {
+            return !(slot.value_.fetch_add(delta, std::memory_order_acq_rel) & kClosed);
+        }
+
+    public:
+        explicit Counter(size_t value) noexcept : central_(kBias + static_cast<intptr_t>(value)) {}
+
+        void Increment() noexcept {
+            Add(1);
+        }
+
+        bool Decrement() noexcept {
+            return Sub(1);
+        }
+
+        void Add(size_t n) noexcept {
+            if (!TryAddToSlot(SlotFor(slots_), static_cast<intptr_t>(n) * kOne)) {
+                central_.fetch_add(static_cast<intptr_t>(n), std::memory_order_relaxed);
+            }
+        }
+
+        // While the bias is in place a decrement can never be the last one
+        bool Sub(size_t n) noexcept {
+            if (TryAddToSlot(SlotFor(slots_), -static_cast<intptr_t>(n) * kOne)) {
+                return false;
+            }
+            return central_.fetch_sub(static_cast<intptr_t>(n), std::memory_order_acq_rel) == static_cast<intptr_t>(n);
+        }
+
+        // An open slot means the bias still holds the object alive
+        bool IncrementIfNonZero() noexcept {
+            if (TryAddToSlot(SlotFor(slots_), kOne)) {
+                return true;
+            }
+            intptr_t value = central_.load(std::memory_order_relaxed);
+            while (value != 0) {
+                if (central_.compare_exchange_weak(value, value + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        // Closes every slot and drops the bias; true when that leaves the count at zero.
+        // Only the first call does anything.
+        bool Retire() noexcept {
+            if (retired_.exchange(true, std::memory_order_acq_rel)) {
+                return false;
+            }
+            intptr_t folded = 0;
+            for (Slot& slot : slots_) {
+                folded += slot.value_.fetch_or(kClosed, std::memory_order_acq_rel) >> 1;
+            }
+            intptr_t delta = folded - kBias;
+            return central_.fetch_add(delta, std::memory_order_acq_rel) + delta == 0;
+        }
+
+        // A snapshot; exact only when no other thread is copying the pointer
+        size_t Load() const noexcept {
+            intptr_t total = central_.load(std::memory_order_acquire);
+            for (const Slot& slot : slots_) {
+                intptr_t value = slot.value_.load(std::memory_order_relaxed);
+                if (!(value & kClosed)) {
+                    total += value >> 1;
+                }
+            }
+            if (!retired_.load(std::memory_order_relaxed)) {
+                total -= kBias;
+            }
+            return static_cast<size_t>(total);
+        }
+    };
+
+    // Weak references are rare on hot objects, a plain atomic count is enough for them
+    using WeakCounter = AtomicPolicy::Counter;
+};
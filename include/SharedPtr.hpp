@@ -1,30 +1,111 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
 #include <memory>
+#include <span>
 #include <stdexcept>
+#include <typeinfo>
+#include <type_traits>
 #include <utility>
 #include "ControlBlock.hpp"
+#include "TriviallyRelocatable.hpp"
 
-template <typename T>
+template <typename T, typename Policy = NonAtomicPolicy>
 class WeakPtr;
 
-template <typename T>
+template <typename T, typename Policy = NonAtomicPolicy>
+class SharedPtr;
+
+template <typename T, typename Policy = NonAtomicPolicy>
+class EnableSharedFromThis;
+
+template <typename T, typename Policy = NonAtomicPolicy>
+class CompactSharedPtr;
+
+template <typename T, typename Policy = NonAtomicPolicy, typename... Args>
+SharedPtr<T, Policy> make_shared(Args&&... args);
+
+template <typename T, typename Policy = NonAtomicPolicy, typename Alloc, typename... Args>
+SharedPtr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args);
+
+template <typename T, typename Policy>
+void release_all(std::span<SharedPtr<T, Policy>> ptrs) noexcept;
+
+template <typename T, typename Policy>
 class SharedPtr { 
 private:
     T* ptr_;
-    ControlBlock* ref_counter_;
+    BasicControlBlock<Policy>* ref_counter_;
 
 public:
-    constexpr SharedPtr() noexcept : ptr_(nullptr), ref_counter_(new ControlBlock(false)) {}
+    // Empty pointers carry no control block, so they never allocate
+    constexpr SharedPtr() noexcept : ptr_(nullptr), ref_counter_(nullptr) {}
+
+    constexpr SharedPtr(std::nullptr_t) noexcept : ptr_(nullptr), ref_counter_(nullptr) {}
     
-    explicit SharedPtr(T* ptr) : ptr_(ptr), ref_counter_(new ControlBlock(true)) {}
+    // The block remembers the original U*, so a derived object is deleted through its own type
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    explicit SharedPtr(U* ptr) : ptr_(ptr), ref_counter_(nullptr) {
+        if (ptr) {
+            try {
+                ref_counter_ = new PointerControlBlock<U, Policy>(ptr);
+            }
+            catch (...) {
+                delete ptr;
+                throw;
+            }
+            SMARTPTR_COUNT(SeparateAllocations);
+        }
+        EnableSharedFromThisHook(ptr);
+    }
+    
+    // The deleter lives in the control block, so SharedPtr<T> stays the same type for any deleter
+    template <typename Deleter, typename = std::enable_if_t<std::is_invocable_v<Deleter&, T*>>>
+    SharedPtr(T* ptr, Deleter deleter) : ptr_(ptr), ref_counter_(nullptr) {
+        try {
+            ref_counter_ = new DeleterControlBlock<T, Deleter, Policy>(ptr, deleter);
+        }
+        catch (...) {
+            deleter(ptr);
+            throw;
+        }
+        SMARTPTR_COUNT(SeparateAllocations);
+        EnableSharedFromThisHook(ptr);
+    }
+
+    template <typename Deleter, typename Alloc, typename = std::enable_if_t<std::is_invocable_v<Deleter&, T*>>>
+    SharedPtr(T* ptr, Deleter deleter, const Alloc& alloc) : ptr_(ptr), ref_counter_(nullptr) {
+        try {
+            ref_counter_ = AllocatedDeleterControlBlock<T, Deleter, Alloc, Policy>::Create(ptr, deleter, alloc);
+        }
+        catch (...) {
+            deleter(ptr);
+            throw;
+        }
+        SMARTPTR_COUNT(SeparateAllocations);
+        EnableSharedFromThisHook(ptr);
+    }
     
-    SharedPtr(T* ptr, ControlBlock* rc) : ptr_(ptr), ref_counter_(std::move(rc)) {
+    SharedPtr(T* ptr, BasicControlBlock<Policy>* rc) : ptr_(ptr), ref_counter_(std::move(rc)) {
+        if (ref_counter_) {
+            ref_counter_->IncrementShared();
+        }
+    }
+
+    // Aliasing: points at ptr (typically a member or a slice of *owner) while sharing owner's control block
+    template <typename U>
+    SharedPtr(const SharedPtr<U, Policy>& owner, T* ptr) noexcept : ptr_(ptr), ref_counter_(owner.ref_counter_) {
         if (ref_counter_) {
             ref_counter_->IncrementShared();
         }
     }
 
+    template <typename U>
+    SharedPtr(SharedPtr<U, Policy>&& owner, T* ptr) noexcept : ptr_(ptr), ref_counter_(owner.ref_counter_) {
+        owner.ptr_ = nullptr;
+        owner.ref_counter_ = nullptr;
+    }
+
     SharedPtr(const SharedPtr& other) : ptr_(other.ptr_), ref_counter_(other.ref_counter_) {
         if (ref_counter_) {
             ref_counter_->IncrementShared();
@@ -36,16 +117,27 @@ public:
         other.ref_counter_ = nullptr;
     }
 
+    // SFINAE
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedPtr(const SharedPtr<U, Policy>& other) : ptr_(other.ptr_), ref_counter_(other.ref_counter_) {
+        if (ref_counter_) {
+            ref_counter_->IncrementShared();
+        }
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    SharedPtr(SharedPtr<U, Policy>&& other) noexcept : ptr_(other.ptr_), ref_counter_(other.ref_counter_) {
+        other.ptr_ = nullptr;
+        other.ref_counter_ = nullptr;
+    }
+
     ~SharedPtr() {
         release();
     }
 
 
-    SharedPtr(const WeakPtr<T>& weak) : ptr_(weak.ptr_), ref_counter_(weak.ref_counter_) {
-        if (ref_counter_ && ref_counter_->SharedCount() > 0) {
-            ref_counter_->IncrementShared();
-        }
-        else {
+    SharedPtr(const WeakPtr<T, Policy>& weak) noexcept : ptr_(weak.ptr_), ref_counter_(weak.ref_counter_) {
+        if (!ref_counter_ || !ref_counter_->TryIncrementShared()) {
             ptr_ = nullptr;
             ref_counter_ = nullptr;
         }
@@ -101,38 +193,299 @@ public:
         return use_count() == 1;
     }
 
-    void reset(T* new_ptr = nullptr) {
-        if (ptr_ != new_ptr) {
+    // True when both pointers share ownership of the same control block
+    template <typename U>
+    bool owner_equal(const SharedPtr<U, Policy>& other) const noexcept {
+        return ref_counter_ == other.ref_counter_;
+    }
+
+    void reset() {
+        release();
+    }
+
+    // A unique owner of a plain new-ed U keeps its control block and only swaps the object.
+    // As with the constructor the object is later deleted as a U, so the block is reused only
+    // when it already holds exactly a U.
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    void reset(U* new_ptr) {
+        if (new_ptr == nullptr) {
+            release();
+            return;
+        }
+        if (new_ptr == ptr_) {
+            return;
+        }
+        if (ReusableBlock<PointerControlBlock<U, Policy>>()) {
+            ptr_ = new_ptr;
+            static_cast<PointerControlBlock<U, Policy>*>(ref_counter_)->Rebind(new_ptr);
+            EnableSharedFromThisHook(new_ptr);
+            return;
+        }
+        SharedPtr(new_ptr).swap(*this);
+    }
+
+    // Like *this = make_shared<T>(args...), but a unique owner reuses its block. The new object
+    // is built before the old one goes, so args may refer into *this and a throwing constructor
+    // leaves the pointer unchanged; it then moves into the old storage, which needs a noexcept move.
+    template <typename... Args>
+    T& reset_emplace(Args&&... args) {
+        if constexpr (std::is_nothrow_move_constructible_v<T>) {
+            if (ReusableBlock<InplaceControlBlock<T, Policy>>()) {
+                InplaceControlBlock<T, Policy>* block = static_cast<InplaceControlBlock<T, Policy>*>(ref_counter_);
+                T fresh(std::forward<Args>(args)...);
+                block->DisposeObject();
+                block->Emplace(std::move(fresh));
+                ptr_ = block->Get();
+                EnableSharedFromThisHook(ptr_);
+                return *ptr_;
+            }
+        }
+        *this = make_shared<T, Policy>(std::forward<Args>(args)...);
+        return *ptr_;
+    }
+
+    void swap(SharedPtr& other) noexcept {
+        std::swap(ptr_, other.ptr_);
+        std::swap(ref_counter_, other.ref_counter_);
+    }
+
+    // Ends the striped phase of a StripedPolicy object: until retired its count never reaches
+    // zero, afterwards the last owner frees it as usual. Retiring twice is harmless.
+    void retire() noexcept
+        requires requires(BasicControlBlock<Policy>& block) { block.RetireShared(); }
+    {
+        if (ref_counter_) {
+            ref_counter_->RetireShared();
+        }
+    }
+
+    // Writes n copies of *this to out with a single count update instead of n increments
+    template <typename OutputIt>
+    OutputIt share_n(size_t n, OutputIt out) const {
+        if (ref_counter_ == nullptr) {
+            for (size_t i = 0; i < n; ++i) {
+                *out++ = SharedPtr();
+            }
+            return out;
+        }
 
-            ptr_ = new_ptr; 
-            
-            if (new_ptr) {
-                ref_counter_ = new ControlBlock(true);
+        ref_counter_->AddShared(n);
+        size_t adopted = 0;
+        try {
+            while (adopted < n) {
+                SharedPtr copy(ptr_, ref_counter_, AdoptBlock{});
+                ++adopted;
+                *out++ = std::move(copy);
             }
-            else {
-                ref_counter_ = nullptr;
+        }
+        catch (...) {
+            // *this still holds a reference, so giving back the unadopted ones never frees the object
+            if (adopted < n) {
+                ref_counter_->SubShared(n - adopted);
             }
+            throw;
         }
+        return out;
     }
 
 
 private:
+    struct AdoptBlock {};
+
+    // Adopts a reference already added to rc
+    SharedPtr(T* ptr, BasicControlBlock<Policy>* rc, AdoptBlock) noexcept : ptr_(ptr), ref_counter_(rc) {}
+
+    // Adopts a freshly created block whose shared count already accounts for this pointer
+    template <typename Block>
+    SharedPtr(Block* block, AdoptBlock) noexcept : ptr_(block->Get()), ref_counter_(block) {
+        SMARTPTR_COUNT(InplaceAllocations);
+        EnableSharedFromThisHook(ptr_);
+    }
+
+    // Points an EnableSharedFromThis base at this control block, unless another owner got there first
+    template <typename U, typename Object>
+    void EnableSharedFromThisHook(const EnableSharedFromThis<U, Policy>* base, Object* object) noexcept {
+        if (base && base->weak_this_.expired()) {
+            base->weak_this_.release();
+            base->weak_this_.ptr_ = const_cast<U*>(static_cast<const U*>(object));
+            base->weak_this_.ref_counter_ = ref_counter_;
+            ref_counter_->IncrementWeak();
+        }
+    }
+
+    void EnableSharedFromThisHook(...) noexcept {}
+
+    template <typename Object>
+    void EnableSharedFromThisHook(Object* object) noexcept {
+        EnableSharedFromThisHook(object, object);
+    }
+
+    // Only an exact Block with no other owners or observers may have its object replaced
+    template <typename Block>
+    bool ReusableBlock() const noexcept {
+        return ref_counter_ && ref_counter_->Unique() && typeid(*ref_counter_) == typeid(Block);
+    }
+
     void release() {
         if (ref_counter_) {
-            ref_counter_->DecrementShared();
-            if (ref_counter_->SharedCount() == 0) {
-                delete ptr_;
-                if (ref_counter_->WeakCount() == 0) {
-                    delete ref_counter_;
-                }
-            }
+            ref_counter_->ReleaseShared();
             ptr_ = nullptr;
             ref_counter_ = nullptr;
         }
     }
 
 
-    friend class WeakPtr<T>;
+    template <typename U, typename P>
+    friend class WeakPtr;
+
+    template <typename U, typename P>
+    friend class SharedPtr;
+
+    template <typename U, typename P, typename... Args>
+    friend SharedPtr<U, P> make_shared(Args&&... args);
+
+    template <typename U, typename P, typename Alloc, typename... Args>
+    friend SharedPtr<U, P> allocate_shared(const Alloc& alloc, Args&&... args);
+
+    template <typename U, typename P>
+    friend class CompactSharedPtr;
+
+    template <typename U, typename P>
+    friend void release_all(std::span<SharedPtr<U, P>> ptrs) noexcept;
+
+    friend class LeakRegistry;
 };
 
 
+// Two plain pointers with no self-references, so a bitwise move is a valid relocation
+template <typename T, typename Policy>
+struct IsTriviallyRelocatable<SharedPtr<T, Policy>> : std::true_type {};
+
+
+// Allocates the control block and the object in a single chunk of memory
+template <typename T, typename Policy, typename... Args>
+SharedPtr<T, Policy> make_shared(Args&&... args) {
+    using Adopt = typename SharedPtr<T, Policy>::AdoptBlock;
+    return SharedPtr<T, Policy>(new InplaceControlBlock<T, Policy>(std::forward<Args>(args)...), Adopt{});
+}
+
+
+// Same single-chunk layout as make_shared, with the memory taken from alloc
+template <typename T, typename Policy, typename Alloc, typename... Args>
+SharedPtr<T, Policy> allocate_shared(const Alloc& alloc, Args&&... args) {
+    using Adopt = typename SharedPtr<T, Policy>::AdoptBlock;
+    return SharedPtr<T, Policy>(AllocatedControlBlock<T, Alloc, Policy>::Create(alloc, std::forward<Args>(args)...), Adopt{});
+}
+
+
+// Empties every pointer in ptrs. References to the same control block are summed in a small
+// direct-mapped table and dropped with one Sub(n) per block, prefetching the blocks ahead of
+// the decrements; for AtomicPolicy that turns n atomic RMWs into one per distinct block.
+template <typename T, typename Policy>
+void release_all(std::span<SharedPtr<T, Policy>> ptrs) noexcept {
+    struct Pending {
+        BasicControlBlock<Policy>* block_;
+        size_t count_;
+    };
+
+    constexpr size_t kSlots = 64;
+    constexpr size_t kPrefetchDistance = 4;
+    Pending pending[kSlots] = {};
+    Pending flushed[kSlots];
+    size_t flushed_count = 0;
+
+    auto drop = [&](Pending* batch, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+#if defined(__GNUC__)
+            if (i + kPrefetchDistance < count) {
+                __builtin_prefetch(batch[i + kPrefetchDistance].block_, 1);
+            }
+#endif
+            batch[i].block_->ReleaseShared(batch[i].count_);
+        }
+    };
+
+    for (SharedPtr<T, Policy>& ptr : ptrs) {
+        BasicControlBlock<Policy>* block = std::exchange(ptr.ref_counter_, nullptr);
+        ptr.ptr_ = nullptr;
+        if (block == nullptr) {
+            continue;
+        }
+
+        Pending& slot = pending[(reinterpret_cast<uintptr_t>(block) >> 4) % kSlots];
+        if (slot.block_ == block) {
+            ++slot.count_;
+            continue;
+        }
+        // Evicted entries are queued and dropped in batches, so prefetching still gets a window
+        if (slot.block_ != nullptr) {
+            flushed[flushed_count++] = slot;
+            if (flushed_count == kSlots) {
+                drop(flushed, flushed_count);
+                flushed_count = 0;
+            }
+        }
+        slot = Pending{block, 1};
+    }
+
+    drop(flushed, flushed_count);
+    size_t remaining = 0;
+    for (Pending& slot : pending) {
+        if (slot.block_ != nullptr) {
+            pending[remaining++] = slot;
+        }
+    }
+    drop(pending, remaining);
+}
+
+
+// Pointer casts share the control block of r; the rvalue overloads move it over without touching the count
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> static_pointer_cast(const SharedPtr<U, Policy>& r) noexcept {
+    return SharedPtr<T, Policy>(r, static_cast<T*>(r.operator->()));
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> static_pointer_cast(SharedPtr<U, Policy>&& r) noexcept {
+    T* ptr = static_cast<T*>(r.operator->());
+    return SharedPtr<T, Policy>(std::move(r), ptr);
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> const_pointer_cast(const SharedPtr<U, Policy>& r) noexcept {
+    return SharedPtr<T, Policy>(r, const_cast<T*>(r.operator->()));
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> const_pointer_cast(SharedPtr<U, Policy>&& r) noexcept {
+    T* ptr = const_cast<T*>(r.operator->());
+    return SharedPtr<T, Policy>(std::move(r), ptr);
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> reinterpret_pointer_cast(const SharedPtr<U, Policy>& r) noexcept {
+    return SharedPtr<T, Policy>(r, reinterpret_cast<T*>(r.operator->()));
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> reinterpret_pointer_cast(SharedPtr<U, Policy>&& r) noexcept {
+    T* ptr = reinterpret_cast<T*>(r.operator->());
+    return SharedPtr<T, Policy>(std::move(r), ptr);
+}
+
+// A failed cast returns an empty pointer and leaves r untouched
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> dynamic_pointer_cast(const SharedPtr<U, Policy>& r) noexcept {
+    if (T* ptr = dynamic_cast<T*>(r.operator->())) {
+        return SharedPtr<T, Policy>(r, ptr);
+    }
+    return SharedPtr<T, Policy>();
+}
+
+template <typename T, typename U, typename Policy>
+SharedPtr<T, Policy> dynamic_pointer_cast(SharedPtr<U, Policy>&& r) noexcept {
+    if (T* ptr = dynamic_cast<T*>(r.operator->())) {
+        return SharedPtr<T, Policy>(std::move(r), ptr);
+    }
+    return SharedPtr<T, Policy>();
+}
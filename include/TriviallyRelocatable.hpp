@@ -0,0 +1,23 @@
+#pragma once
+#include <type_traits>
+
+#if defined(__has_builtin)
+#if __has_builtin(__is_trivially_relocatable)
+#define SMARTPTR_HAS_RELOCATABLE_BUILTIN
+#endif
+#endif
+
+// A type is trivially relocatable when moving an object to new storage and destroying the
+// source amounts to copying its bytes (P1144). Trivially copyable types always are; where the
+// compiler has the builtin it also sees [[trivially_relocatable]] / [[clang::trivial_abi]]
+// types. The smart pointers of this library opt in by specialising the trait.
+template <typename T>
+struct IsTriviallyRelocatable
+#ifdef SMARTPTR_HAS_RELOCATABLE_BUILTIN
+    : std::bool_constant<__is_trivially_relocatable(T) || std::is_trivially_copyable_v<T>> {};
+#else
+    : std::is_trivially_copyable<T> {};
+#endif
+
+template <typename T>
+inline constexpr bool is_trivially_relocatable_v = IsTriviallyRelocatable<T>::value;
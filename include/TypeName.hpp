@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdlib>
+#include <string>
+#include <typeinfo>
+#if __has_include(<cxxabi.h>)
+#include <cxxabi.h>
+#endif
+
+// Human-readable type name for diagnostics; falls back to the mangled name
+inline std::string DemangledTypeName(const std::type_info& type) {
+#if __has_include(<cxxabi.h>)
+    int status = 0;
+    char* demangled = abi::__cxa_demangle(type.name(), nullptr, nullptr, &status);
+    if (status == 0 && demangled) {
+        std::string name(demangled);
+        std::free(demangled);
+        return name;
+    }
+#endif
+    return type.name();
+}
@@ -1,33 +1,86 @@
 #pragma once
+#include <cstddef>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include "Instrumentation.hpp"
+#include "TriviallyRelocatable.hpp"
 
 template <typename T>
+struct DefaultDelete {
+    constexpr DefaultDelete() noexcept = default;
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    DefaultDelete(const DefaultDelete<U>&) noexcept {}
+
+    void operator()(T* ptr) const noexcept {
+        static_assert(sizeof(T) > 0, "Cannot delete an incomplete type");
+        delete ptr;
+    }
+};
+
+template <typename T>
+struct DefaultDelete<T[]> {
+    constexpr DefaultDelete() noexcept = default;
+
+    void operator()(T* ptr) const noexcept {
+        static_assert(sizeof(T) > 0, "Cannot delete an incomplete type");
+        delete[] ptr;
+    }
+};
+
+template <typename T, typename Deleter = DefaultDelete<T>>
 class UniquePtr {
 private:
     T* ptr_;
+    // Stateless deleters occupy no storage, so UniquePtr<T> stays the size of a raw pointer
+    [[no_unique_address]] Deleter deleter_;
     
 public:
-    UniquePtr(T* ptr = nullptr) : ptr_(ptr) {}
+    // A value-initialised pointer deleter would be null, so those must be passed explicitly
+    UniquePtr(T* ptr = nullptr) noexcept
+        requires (!std::is_pointer_v<Deleter> && std::is_default_constructible_v<Deleter>)
+        : ptr_(ptr), deleter_() {
+        Acquired(ptr_);
+    }
+
+    UniquePtr(T* ptr, const Deleter& deleter) noexcept : ptr_(ptr), deleter_(deleter) {
+        Acquired(ptr_);
+    }
+
+    UniquePtr(T* ptr, Deleter&& deleter) noexcept : ptr_(ptr), deleter_(std::move(deleter)) {
+        Acquired(ptr_);
+    }
 
     ~UniquePtr() {
         if (ptr_) {
-            delete ptr_;
+            Released(ptr_);
+            deleter_(ptr_);
         }
     }
 
     UniquePtr(const UniquePtr&) = delete;
     UniquePtr& operator=(const UniquePtr&) = delete;
 
+    UniquePtr(UniquePtr&& other_ptr) noexcept : ptr_(std::exchange(other_ptr.ptr_, nullptr)), deleter_(std::move(other_ptr.deleter_)) {}
+
     // SFINAE
-    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
-    UniquePtr(UniquePtr<U>&& other_ptr) noexcept : ptr_(other_ptr.release()) {
-        other_ptr.ptr_ = nullptr;
+    template <typename U, typename E, typename = std::enable_if_t<std::is_convertible_v<U*, T*> && std::is_convertible_v<E, Deleter>>>
+    UniquePtr(UniquePtr<U, E>&& other_ptr) noexcept : ptr_(std::exchange(other_ptr.ptr_, nullptr)), deleter_(std::move(other_ptr.deleter_)) {
+        if (ptr_) {
+            SMARTPTR_TRACK_LIVE(U, -1);
+            SMARTPTR_TRACK_LIVE(T, 1);
+        }
     }
 
     UniquePtr& operator=(UniquePtr&& other_ptr) noexcept {
         if (this != &other_ptr) {
-            reset(other_ptr.release());
+            T* old_ptr = std::exchange(ptr_, std::exchange(other_ptr.ptr_, nullptr));
+            if (old_ptr) {
+                Released(old_ptr);
+                deleter_(old_ptr);
+            }
+            deleter_ = std::move(other_ptr.deleter_);
         }
         return *this;
     }
@@ -46,14 +99,26 @@ public:
     T* release() noexcept {
         T* tmp = ptr_;
         ptr_ = nullptr;
+        Released(tmp);
         return tmp;
     }
 
     void reset(T* new_ptr = nullptr) noexcept {
-        if (ptr_) {
-            delete ptr_;
-        }
+        T* old_ptr = ptr_;
         ptr_ = new_ptr;
+        Acquired(new_ptr);
+        if (old_ptr) {
+            Released(old_ptr);
+            deleter_(old_ptr);
+        }
+    }
+
+    Deleter& get_deleter() noexcept {
+        return deleter_;
+    }
+
+    const Deleter& get_deleter() const noexcept {
+        return deleter_;
     }
 
     bool operator==(const UniquePtr& other) const noexcept {
@@ -64,14 +129,140 @@ public:
         return ptr_ != other.ptr_;
     }
 
+
+private:
+    // Instrumentation hooks for ownership entering and leaving a UniquePtr
+    static void Acquired(T* ptr) noexcept {
+        if (ptr) {
+            SMARTPTR_COUNT(UniqueAcquired);
+            SMARTPTR_TRACK_LIVE(T, 1);
+        }
+    }
+
+    static void Released(T* ptr) noexcept {
+        if (ptr) {
+            SMARTPTR_COUNT(UniqueReleased);
+            SMARTPTR_TRACK_LIVE(T, -1);
+        }
+    }
+
     // Friend declaration to allow access to private members
-    template <typename U>
+    template <typename U, typename E>
     friend class UniquePtr;
 };
 
+// Array specialisation: releases with delete[] and provides indexed access instead of * and ->
+template <typename T, typename Deleter>
+class UniquePtr<T[], Deleter> {
+private:
+    T* ptr_;
+    [[no_unique_address]] Deleter deleter_;
+
+public:
+    UniquePtr(T* ptr = nullptr) noexcept
+        requires (!std::is_pointer_v<Deleter> && std::is_default_constructible_v<Deleter>)
+        : ptr_(ptr), deleter_() {
+        Acquired(ptr_);
+    }
+
+    UniquePtr(T* ptr, const Deleter& deleter) noexcept : ptr_(ptr), deleter_(deleter) {
+        Acquired(ptr_);
+    }
+
+    UniquePtr(T* ptr, Deleter&& deleter) noexcept : ptr_(ptr), deleter_(std::move(deleter)) {
+        Acquired(ptr_);
+    }
+
+    ~UniquePtr() {
+        if (ptr_) {
+            Released(ptr_);
+            deleter_(ptr_);
+        }
+    }
+
+    UniquePtr(const UniquePtr&) = delete;
+    UniquePtr& operator=(const UniquePtr&) = delete;
+
+    UniquePtr(UniquePtr&& other_ptr) noexcept : ptr_(std::exchange(other_ptr.ptr_, nullptr)), deleter_(std::move(other_ptr.deleter_)) {}
+
+    UniquePtr& operator=(UniquePtr&& other_ptr) noexcept {
+        if (this != &other_ptr) {
+            T* old_ptr = std::exchange(ptr_, std::exchange(other_ptr.ptr_, nullptr));
+            if (old_ptr) {
+                Released(old_ptr);
+                deleter_(old_ptr);
+            }
+            deleter_ = std::move(other_ptr.deleter_);
+        }
+        return *this;
+    }
+
+    T& operator[](std::size_t index) const noexcept {
+        return ptr_[index];
+    }
+
+    const T* get() const noexcept { return ptr_; }
+
+    explicit operator bool() const noexcept {
+        return ptr_ != nullptr;
+    }
+
+    T* release() noexcept {
+        T* tmp = ptr_;
+        ptr_ = nullptr;
+        Released(tmp);
+        return tmp;
+    }
+
+    void reset(T* new_ptr = nullptr) noexcept {
+        T* old_ptr = ptr_;
+        ptr_ = new_ptr;
+        Acquired(new_ptr);
+        if (old_ptr) {
+            Released(old_ptr);
+            deleter_(old_ptr);
+        }
+    }
+
+    Deleter& get_deleter() noexcept {
+        return deleter_;
+    }
+
+    const Deleter& get_deleter() const noexcept {
+        return deleter_;
+    }
+
+    bool operator==(const UniquePtr& other) const noexcept {
+        return ptr_ == other.ptr_;
+    }
+
+    bool operator!=(const UniquePtr& other) const noexcept {
+        return ptr_ != other.ptr_;
+    }
+private:
+    // Instrumentation hooks for ownership entering and leaving a UniquePtr
+    static void Acquired(T* ptr) noexcept {
+        if (ptr) {
+            SMARTPTR_COUNT(UniqueAcquired);
+            SMARTPTR_TRACK_LIVE(T, 1);
+        }
+    }
+
+    static void Released(T* ptr) noexcept {
+        if (ptr) {
+            SMARTPTR_COUNT(UniqueReleased);
+            SMARTPTR_TRACK_LIVE(T, -1);
+        }
+    }
+};
+
+// Relocatable whenever the deleter is (always the case for the stateless default ones)
+template <typename T, typename Deleter>
+struct IsTriviallyRelocatable<UniquePtr<T, Deleter>> : IsTriviallyRelocatable<Deleter> {};
+
 // Implementation of make_unique for types with constructor parameters
 template <typename T, typename... Args>
-UniquePtr<T> make_unique(Args&&... args) {
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> make_unique(Args&&... args) {
     return UniquePtr<T>(new T(std::forward<Args>(args)...));
 }
 
@@ -81,3 +272,17 @@ UniquePtr<T[]> make_unique_array(std::size_t size) {
     return UniquePtr<T[]>(new T[size]());
 }
 
+// Default-initialises instead of value-initialising, so large buffers are not zeroed first
+template <typename T>
+std::enable_if_t<!std::is_array_v<T>, UniquePtr<T>> make_unique_for_overwrite() {
+    return UniquePtr<T>(new T);
+}
+
+template <typename T>
+std::enable_if_t<std::is_unbounded_array_v<T>, UniquePtr<T>> make_unique_for_overwrite(std::size_t size) {
+    return UniquePtr<T>(new std::remove_extent_t<T>[size]);
+}
+
+// Like std::make_unique_for_overwrite, bounded arrays are not supported
+template <typename T, typename... Args>
+std::enable_if_t<std::is_bounded_array_v<T>> make_unique_for_overwrite(Args&&...) = delete;
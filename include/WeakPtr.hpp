@@ -1,18 +1,20 @@
 #pragma once
 #include <cstddef>
+#include <type_traits>
 #include "ControlBlock.hpp"
 #include "SharedPtr.hpp"
+#include "TriviallyRelocatable.hpp"
 
-template <typename T>
+template <typename T, typename Policy>
 class WeakPtr {
 private:
     T* ptr_;
-    ControlBlock* ref_counter_;
+    BasicControlBlock<Policy>* ref_counter_;
 
 public:
     WeakPtr() noexcept : ptr_(nullptr), ref_counter_(nullptr) {}
 
-    WeakPtr(const SharedPtr<T>& shared) noexcept : ptr_(shared.ptr_), ref_counter_(shared.ref_counter_) {
+    WeakPtr(const SharedPtr<T, Policy>& shared) noexcept : ptr_(shared.ptr_), ref_counter_(shared.ref_counter_) {
         if (ref_counter_) {
             ref_counter_->IncrementWeak();
         }
@@ -29,6 +31,27 @@ public:
         other.ref_counter_ = nullptr;
     }
 
+    // SFINAE
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    WeakPtr(const SharedPtr<U, Policy>& shared) noexcept : ptr_(shared.ptr_), ref_counter_(shared.ref_counter_) {
+        if (ref_counter_) {
+            ref_counter_->IncrementWeak();
+        }
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    WeakPtr(const WeakPtr<U, Policy>& other) noexcept : ptr_(other.ptr_), ref_counter_(other.ref_counter_) {
+        if (ref_counter_) {
+            ref_counter_->IncrementWeak();
+        }
+    }
+
+    template <typename U, typename = std::enable_if_t<std::is_convertible_v<U*, T*>>>
+    WeakPtr(WeakPtr<U, Policy>&& other) noexcept : ptr_(other.ptr_), ref_counter_(other.ref_counter_) {
+        other.ptr_ = nullptr;
+        other.ref_counter_ = nullptr;
+    }
+
     ~WeakPtr() {
         release();
     }
@@ -56,7 +79,7 @@ public:
         return *this;
     }
 
-    WeakPtr& operator=(const SharedPtr<T>& shared) noexcept {
+    WeakPtr& operator=(const SharedPtr<T, Policy>& shared) noexcept {
         release();
         ptr_ = shared.ptr_;
         ref_counter_ = shared.ref_counter_;
@@ -66,11 +89,14 @@ public:
         return *this;
     }
 
-    SharedPtr<T> lock() const noexcept {
-        if (ref_counter_ && ref_counter_->SharedCount() > 0) { 
-            return SharedPtr<T>(*this);
+    // The check and the increment are a single atomic step, so an expiring object is never resurrected
+    SharedPtr<T, Policy> lock() const noexcept {
+        SharedPtr<T, Policy> locked(*this);
+        SMARTPTR_COUNT(Locks);
+        if (!locked.ref_counter_) {
+            SMARTPTR_COUNT(LockFailures);
         }
-        return SharedPtr<T>();
+        return locked;
     }
 
     size_t use_count() const noexcept {
@@ -88,14 +114,19 @@ public:
 private:
     void release() {
         if (ref_counter_) {
-            ref_counter_->DecrementWeak();
-            if (ref_counter_->SharedCount() == 0 && ref_counter_->WeakCount() == 0) {
-                delete ref_counter_;
-            }
+            ref_counter_->ReleaseWeak();
             ptr_ = nullptr;
             ref_counter_ = nullptr;
         }
     }
 
-    friend class SharedPtr<T>;
+    template <typename U, typename P>
+    friend class SharedPtr;
+
+    template <typename U, typename P>
+    friend class WeakPtr;
 };
+
+
+template <typename T, typename Policy>
+struct IsTriviallyRelocatable<WeakPtr<T, Policy>> : std::true_type {};
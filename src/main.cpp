@@ -7,6 +7,8 @@
 #include "../include/WeakPtr.hpp"
 #include "../include/SharedPtr.hpp"
 #include "../include/UniquePtr.hpp"
+#include "../include/PtrVector.hpp"
+#include "../include/ObjectPool.hpp"
 
 template<typename T>
 class Resource {
@@ -25,6 +27,12 @@ public:
         }
     }
 
+    // Copies into the existing members, so a recycled resource keeps their storage
+    void assign(const std::string& name, const T& value) {
+        name_ = name;
+        value_ = value;
+    }
+
     void print() const {
         std::cout << "Resource " << name_ << " has value ";
         printValue(value_);
@@ -51,9 +59,10 @@ private:
 template<typename T>
 class SmartPointerManagerBase {
 public:
-    using SharedPtrVector = std::vector<SharedPtr<Resource<T>>>;
-    using UniquePtrVector = std::vector<UniquePtr<Resource<T>>>;
-    using WeakPtrVector = std::vector<WeakPtr<Resource<T>>>;
+    // Smart pointers are trivially relocatable, so growth is a memcpy rather than per-element moves
+    using SharedPtrVector = PtrVector<SharedPtr<Resource<T>>>;
+    using UniquePtrVector = PtrVector<UniquePtr<Resource<T>>>;
+    using WeakPtrVector = PtrVector<WeakPtr<Resource<T>>>;
 
     size_t getSharedPtrsSize() const {
         return sharedPtrs.size();
@@ -177,9 +186,12 @@ public:
     void createMultipleSharedPtrs(int count) {
         T value = createResourceValue<T>();
 
+        // Resources dropped by removeCreatedSharedPtrs come back from the pool instead of being rebuilt
         auto start = std::chrono::high_resolution_clock::now();
         for (int i = 0; i < count; ++i) {
-            sharedPtrs.push_back(SharedPtr<Resource<T>>(new Resource<T>("MultiShared", value, true)));
+            SharedPtr<Resource<T>> resource = resourcePool.acquire();
+            resource->assign("MultiShared", value);
+            sharedPtrs.push_back(std::move(resource));
         }
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = end - start;
@@ -402,6 +414,7 @@ public:
         std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
     }
 
+    ObjectPool<Resource<T>> resourcePool{[] { return new Resource<T>("MultiShared", T(), true); }};
     SharedPtrVector sharedPtrs;
 
     template<typename U>
@@ -990,6 +1003,9 @@ void weakPtrMenu() {
 
 
 int main() {
+#ifdef SMARTPTR_DEBUG_REGISTRY
+    LeakRegistry::ReportAtExit();
+#endif
     while (true) {
         std::cout << "\nMain Menu:\n";
         std::cout << "\n1.  ➤   SharedPtr Menu\n";
@@ -0,0 +1,118 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include "../include/AtomicSharedPtr.hpp"
+
+struct Config {
+    static std::atomic<int> alive;
+    int version_;
+
+    explicit Config(int version) : version_(version) {
+        alive++;
+    }
+
+    ~Config() {
+        alive--;
+    }
+};
+
+std::atomic<int> Config::alive{0};
+
+using ConfigPtr = SharedPtr<Config, AtomicPolicy>;
+
+
+TEST(AtomicSharedPtrTest, DefaultIsEmpty) {
+    AtomicSharedPtr<Config> slot;
+    EXPECT_EQ(slot.load().get(), nullptr);
+    EXPECT_TRUE(slot.is_lock_free());
+}
+
+
+TEST(AtomicSharedPtrTest, LoadStore) {
+    {
+        AtomicSharedPtr<Config> slot(make_shared<Config, AtomicPolicy>(1));
+        ConfigPtr loaded = slot.load();
+        EXPECT_EQ(loaded->version_, 1);
+        EXPECT_EQ(loaded.use_count(), 2);
+
+        slot.store(make_shared<Config, AtomicPolicy>(2));
+        EXPECT_EQ(slot.load()->version_, 2);
+        EXPECT_EQ(loaded.use_count(), 1);
+        EXPECT_EQ(Config::alive, 2);
+    }
+    EXPECT_EQ(Config::alive, 0);
+}
+
+
+TEST(AtomicSharedPtrTest, Exchange) {
+    AtomicSharedPtr<Config> slot(make_shared<Config, AtomicPolicy>(1));
+    ConfigPtr old = slot.exchange(make_shared<Config, AtomicPolicy>(2));
+    EXPECT_EQ(old->version_, 1);
+    EXPECT_EQ(old.use_count(), 1);
+    EXPECT_EQ(slot.load()->version_, 2);
+}
+
+
+TEST(AtomicSharedPtrTest, CompareExchange) {
+    ConfigPtr first = make_shared<Config, AtomicPolicy>(1);
+    AtomicSharedPtr<Config> slot(first);
+
+    ConfigPtr expected = make_shared<Config, AtomicPolicy>(99);
+    EXPECT_FALSE(slot.compare_exchange_strong(expected, make_shared<Config, AtomicPolicy>(2)));
+    EXPECT_EQ(expected.get(), first.get());
+
+    EXPECT_TRUE(slot.compare_exchange_strong(expected, make_shared<Config, AtomicPolicy>(3)));
+    EXPECT_EQ(slot.load()->version_, 3);
+    EXPECT_EQ(first.use_count(), 2);
+
+    ConfigPtr empty;
+    AtomicSharedPtr<Config> empty_slot;
+    EXPECT_TRUE(empty_slot.compare_exchange_strong(empty, first));
+    EXPECT_EQ(empty_slot.load().get(), first.get());
+}
+
+
+TEST(AtomicSharedPtrTest, ConcurrentReadersAndWriter) {
+    {
+        AtomicSharedPtr<Config> slot(make_shared<Config, AtomicPolicy>(0));
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([&slot, &done] {
+                int last_seen = 0;
+                while (!done.load()) {
+                    ConfigPtr config = slot.load();
+                    ASSERT_NE(config.get(), nullptr);
+                    EXPECT_GE(config->version_, last_seen);
+                    last_seen = config->version_;
+                }
+            });
+        }
+
+        for (int version = 1; version <= 5000; ++version) {
+            slot.store(make_shared<Config, AtomicPolicy>(version));
+        }
+
+        ConfigPtr expected = slot.load();
+        for (int version = 5001; version <= 6000; ++version) {
+            while (!slot.compare_exchange_weak(expected, make_shared<Config, AtomicPolicy>(version))) {
+            }
+            expected = slot.load();
+        }
+
+        done.store(true);
+        for (auto& reader : readers) {
+            reader.join();
+        }
+        EXPECT_EQ(slot.load()->version_, 6000);
+    }
+    EXPECT_EQ(Config::alive, 0);
+}
+
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+#include "../include/CompactSharedPtr.hpp"
+#include "../include/EnableSharedFromThis.hpp"
+#include "../include/WeakPtr.hpp"
+
+struct Payload {
+    static int alive;
+    std::string name_;
+
+    explicit Payload(std::string name) : name_(std::move(name)) {
+        alive++;
+    }
+
+    ~Payload() {
+        alive--;
+    }
+};
+
+int Payload::alive = 0;
+
+struct Self : EnableSharedFromThis<Self> {
+    int value_ = 5;
+};
+
+
+TEST(CompactSharedPtrTest, IsOneWord) {
+    static_assert(sizeof(CompactSharedPtr<Payload>) == sizeof(void*));
+    static_assert(sizeof(CompactSharedPtr<Payload, AtomicPolicy>) == sizeof(void*));
+
+    CompactSharedPtr<Payload> empty;
+    EXPECT_FALSE(empty);
+    EXPECT_EQ(empty.get(), nullptr);
+    EXPECT_EQ(empty.use_count(), 0u);
+    EXPECT_THROW(*empty, std::runtime_error);
+}
+
+TEST(CompactSharedPtrTest, SharesOwnership) {
+    {
+        CompactSharedPtr<Payload> ptr = make_compact_shared<Payload>("first");
+        EXPECT_EQ(ptr->name_, "first");
+        EXPECT_EQ(ptr.use_count(), 1u);
+
+        CompactSharedPtr<Payload> copy(ptr);
+        EXPECT_EQ(ptr.use_count(), 2u);
+        EXPECT_EQ(copy.get(), ptr.get());
+        EXPECT_TRUE(copy == ptr);
+
+        CompactSharedPtr<Payload> moved(std::move(copy));
+        EXPECT_FALSE(copy);
+        EXPECT_EQ(ptr.use_count(), 2u);
+
+        moved.reset();
+        EXPECT_EQ(ptr.use_count(), 1u);
+        EXPECT_EQ(Payload::alive, 1);
+    }
+    EXPECT_EQ(Payload::alive, 0);
+}
+
+TEST(CompactSharedPtrTest, ConvertsToSharedPtr) {
+    WeakPtr<Payload> weak;
+    {
+        CompactSharedPtr<Payload> compact = make_compact_shared<Payload>("shared");
+        SharedPtr<Payload> shared = compact;
+        EXPECT_EQ(shared.get(), compact.get());
+        EXPECT_EQ(compact.use_count(), 2u);
+
+        weak = compact.to_shared();
+        EXPECT_EQ(weak.use_count(), 2u);
+    }
+    EXPECT_TRUE(weak.expired());
+    EXPECT_EQ(Payload::alive, 0);
+
+    CompactSharedPtr<Self> self = make_compact_shared<Self>();
+    EXPECT_EQ(self->shared_from_this().get(), self.get());
+}
+
+TEST(CompactSharedPtrTest, VectorOfCompactPointers) {
+    std::vector<CompactSharedPtr<Payload>> items;
+    for (int i = 0; i < 100; ++i) {
+        items.push_back(make_compact_shared<Payload>(std::to_string(i)));
+    }
+    std::vector<CompactSharedPtr<Payload>> copies = items;
+    EXPECT_EQ(Payload::alive, 100);
+    EXPECT_EQ(copies[42]->name_, "42");
+    EXPECT_EQ(items[42].use_count(), 2u);
+
+    items.clear();
+    copies.clear();
+    EXPECT_EQ(Payload::alive, 0);
+}
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "../include/HazardPointer.hpp"
+
+struct Tracked {
+    static std::atomic<int> alive;
+    int value_;
+
+    explicit Tracked(int value) : value_(value) {
+        alive++;
+    }
+
+    ~Tracked() {
+        value_ = -1;
+        alive--;
+    }
+};
+
+std::atomic<int> Tracked::alive{0};
+
+
+TEST(HazardPointerTest, ProtectedObjectIsNotReclaimed) {
+    HazardDomain domain;
+    std::atomic<Tracked*> source{new Tracked(1)};
+
+    HazardPointer hazard(domain);
+    Tracked* protected_ptr = hazard.protect(source);
+    EXPECT_EQ(protected_ptr->value_, 1);
+
+    Tracked* old = source.exchange(new Tracked(2));
+    domain.retire(old);
+    domain.reclaim();
+    EXPECT_EQ(Tracked::alive, 2);
+    EXPECT_EQ(protected_ptr->value_, 1);
+
+    hazard.reset_protection();
+    domain.reclaim();
+    EXPECT_EQ(Tracked::alive, 1);
+
+    delete source.load();
+}
+
+
+TEST(HazardPointerTest, RetireBatchesReclamation) {
+    HazardDomain domain;
+    for (size_t i = 0; i < HazardDomain::kRetireThreshold - 1; ++i) {
+        domain.retire(new Tracked(0));
+    }
+    EXPECT_EQ(Tracked::alive, static_cast<int>(HazardDomain::kRetireThreshold - 1));
+
+    domain.retire(new Tracked(0));
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+
+TEST(HazardPointerTest, ProtectedBacklogDoesNotRescanEveryRetire) {
+    HazardDomain domain;
+    std::vector<std::unique_ptr<HazardPointer>> hazards;
+    std::vector<std::atomic<Tracked*>> sources(HazardDomain::kMaxSlots);
+    for (auto& source : sources) {
+        source.store(new Tracked(0));
+        hazards.push_back(std::make_unique<HazardPointer>(domain));
+        hazards.back()->protect(source);
+        domain.retire(source.load());
+    }
+
+    // The first scan frees the unprotected half and keeps the protected backlog
+    size_t unprotected = HazardDomain::kRetireThreshold - HazardDomain::kMaxSlots;
+    for (size_t i = 0; i < unprotected; ++i) {
+        domain.retire(new Tracked(0));
+    }
+    EXPECT_EQ(Tracked::alive, static_cast<int>(HazardDomain::kMaxSlots));
+
+    // The next scan waits for a full threshold of new retirements
+    for (size_t i = 0; i < HazardDomain::kRetireThreshold - 1; ++i) {
+        domain.retire(new Tracked(0));
+    }
+    EXPECT_EQ(Tracked::alive, static_cast<int>(HazardDomain::kMaxSlots + HazardDomain::kRetireThreshold - 1));
+    domain.retire(new Tracked(0));
+    EXPECT_EQ(Tracked::alive, static_cast<int>(HazardDomain::kMaxSlots));
+
+    hazards.clear();
+    domain.reclaim();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+
+TEST(HazardPointerTest, ConcurrentReadersAndWriter) {
+    {
+        HazardDomain domain;
+        std::atomic<Tracked*> source{new Tracked(0)};
+        std::atomic<bool> done{false};
+
+        std::vector<std::thread> readers;
+        for (int i = 0; i < 4; ++i) {
+            readers.emplace_back([&domain, &source, &done] {
+                HazardPointer hazard(domain);
+                while (!done.load()) {
+                    Tracked* ptr = hazard.protect(source);
+                    EXPECT_GE(ptr->value_, 0);
+                    hazard.reset_protection();
+                }
+            });
+        }
+
+        for (int value = 1; value <= 20000; ++value) {
+            domain.retire(source.exchange(new Tracked(value)));
+        }
+
+        done.store(true);
+        for (auto& reader : readers) {
+            reader.join();
+        }
+
+        domain.reclaim();
+        EXPECT_EQ(Tracked::alive, 1);
+        delete source.load();
+    }
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+
+TEST(HazardPointerTest, ExitedThreadHandsOverRetiredObjects) {
+    HazardDomain domain;
+    std::atomic<Tracked*> source{new Tracked(1)};
+    HazardPointer hazard(domain);
+    hazard.protect(source);
+
+    std::thread writer([&domain, &source] {
+        domain.retire(source.exchange(nullptr));
+    });
+    writer.join();
+    EXPECT_EQ(Tracked::alive, 1);
+
+    hazard.reset_protection();
+    domain.reclaim();
+    EXPECT_EQ(Tracked::alive, 0);
+}
+
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
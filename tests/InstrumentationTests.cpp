@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <thread>
+#include "../include/SharedPtr.hpp"
+#include "../include/WeakPtr.hpp"
+#include "../include/UniquePtr.hpp"
+
+using Event = Instrumentation::Event;
+
+struct Widget {
+    int value_ = 0;
+};
+
+struct Gadget {
+    int value_ = 0;
+};
+
+static uint64_t Delta(const Instrumentation::Snapshot& before, Event event) {
+    return Instrumentation::Collect()[event] - before[event];
+}
+
+static int64_t LiveCountOf(const std::string& type_name) {
+    std::vector<Instrumentation::LiveCount> live = Instrumentation::LiveObjects();
+    auto it = std::find_if(live.begin(), live.end(), [&](const Instrumentation::LiveCount& entry) {
+        return entry.type_name_ == type_name;
+    });
+    return it == live.end() ? 0 : it->live_;
+}
+
+
+TEST(InstrumentationTest, CountsBlocksAndRefcounts) {
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    {
+        SharedPtr<Widget> separate(new Widget());
+        SharedPtr<Widget> inplace = make_shared<Widget>();
+        SharedPtr<Widget> copy(inplace);
+        WeakPtr<Widget> weak(copy);
+    }
+    EXPECT_EQ(Delta(before, Event::BlocksCreated), 2u);
+    EXPECT_EQ(Delta(before, Event::BlocksDestroyed), 2u);
+    EXPECT_EQ(Delta(before, Event::SeparateAllocations), 1u);
+    EXPECT_EQ(Delta(before, Event::InplaceAllocations), 1u);
+    EXPECT_EQ(Delta(before, Event::SharedIncrements), 1u);
+    EXPECT_EQ(Delta(before, Event::SharedDecrements), 3u);
+    EXPECT_EQ(Delta(before, Event::WeakIncrements), 1u);
+}
+
+TEST(InstrumentationTest, CountsLockFailures) {
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    WeakPtr<Widget> weak;
+    {
+        SharedPtr<Widget> shared = make_shared<Widget>();
+        weak = shared;
+        EXPECT_TRUE(weak.lock());
+    }
+    EXPECT_FALSE(weak.lock());
+    EXPECT_EQ(Delta(before, Event::Locks), 2u);
+    EXPECT_EQ(Delta(before, Event::LockFailures), 1u);
+}
+
+TEST(InstrumentationTest, AggregatesOtherThreads) {
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    std::thread worker([] {
+        for (int i = 0; i < 10; ++i) {
+            SharedPtr<Widget> shared = make_shared<Widget>();
+        }
+    });
+    worker.join();
+    EXPECT_EQ(Delta(before, Event::BlocksCreated), 10u);
+}
+
+TEST(InstrumentationTest, TracksLiveObjectsPerType) {
+    const std::string gadget_name = "Gadget";
+    {
+        SharedPtr<Gadget> shared = make_shared<Gadget>();
+        UniquePtr<Gadget> unique = make_unique<Gadget>();
+        UniquePtr<Gadget> moved(std::move(unique));
+        EXPECT_EQ(LiveCountOf(gadget_name), 2);
+
+        std::ostringstream dump;
+        Instrumentation::DumpLiveObjects(dump);
+        EXPECT_NE(dump.str().find("Gadget: 2"), std::string::npos);
+
+        Gadget* raw = moved.release();
+        EXPECT_EQ(LiveCountOf(gadget_name), 1);
+        delete raw;
+    }
+    EXPECT_EQ(LiveCountOf(gadget_name), 0);
+}
+
+TEST(InstrumentationTest, CountsUniqueOwnership) {
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    {
+        UniquePtr<Widget> first(new Widget());
+        UniquePtr<Widget> second;
+        second = std::move(first);
+        second.reset(new Widget());
+    }
+    EXPECT_EQ(Delta(before, Event::UniqueAcquired), 2u);
+    EXPECT_EQ(Delta(before, Event::UniqueReleased), 2u);
+}
+
+TEST(InstrumentationTest, CountsReleasesDuringThreadExit) {
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    std::thread worker([] {
+        // Constructed before the thread's counters, so destroyed after them
+        static thread_local SharedPtr<Widget> held;
+        held = make_shared<Widget>();
+    });
+    worker.join();
+    EXPECT_EQ(Delta(before, Event::BlocksCreated), 1u);
+    EXPECT_EQ(Delta(before, Event::BlocksDestroyed), 1u);
+    EXPECT_EQ(Delta(before, Event::SharedDecrements), 1u);
+}
+
+
+TEST(InstrumentationTest, UniqueResetReusesBlock) {
+    SharedPtr<Widget> separate(new Widget());
+    SharedPtr<Widget> inplace = make_shared<Widget>();
+    Instrumentation::Snapshot before = Instrumentation::Collect();
+    for (int i = 0; i < 10; ++i) {
+        separate.reset(new Widget());
+        inplace.reset_emplace();
+    }
+    EXPECT_EQ(Delta(before, Event::BlocksCreated), 0u);
+    EXPECT_EQ(Delta(before, Event::BlocksDestroyed), 0u);
+}
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+#include "../include/IntrusivePtr.hpp"
+
+class Node : public RefCounted<Node> {
+public:
+    static int counter;
+    int value_;
+
+    explicit Node(int value = 0) : value_(value) {
+        counter++;
+    }
+
+    virtual ~Node() {
+        counter--;
+    }
+};
+
+int Node::counter = 0;
+
+class DerivedNode : public Node {
+public:
+    explicit DerivedNode(int value) : Node(value) {}
+};
+
+class AtomicNode : public RefCounted<AtomicNode, AtomicPolicy> {
+public:
+    static std::atomic<int> counter;
+
+    AtomicNode() {
+        counter++;
+    }
+
+    ~AtomicNode() {
+        counter--;
+    }
+};
+
+std::atomic<int> AtomicNode::counter{0};
+
+
+static_assert(sizeof(IntrusivePtr<Node>) == sizeof(Node*));
+
+
+TEST(IntrusivePtrTest, DefaultConstructor) {
+    IntrusivePtr<Node> ptr;
+    EXPECT_EQ(ptr.get(), nullptr);
+    EXPECT_EQ(ptr.use_count(), 0);
+}
+
+
+TEST(IntrusivePtrTest, MakeIntrusive) {
+    {
+        IntrusivePtr<Node> ptr = make_intrusive<Node>(42);
+        EXPECT_EQ(ptr->value_, 42);
+        EXPECT_EQ(ptr.use_count(), 1);
+        EXPECT_EQ(Node::counter, 1);
+    }
+    EXPECT_EQ(Node::counter, 0);
+}
+
+
+TEST(IntrusivePtrTest, CopyAndMove) {
+    IntrusivePtr<Node> ptr1 = make_intrusive<Node>(1);
+    IntrusivePtr<Node> ptr2(ptr1);
+    EXPECT_EQ(ptr1.use_count(), 2);
+
+    IntrusivePtr<Node> ptr3(std::move(ptr2));
+    EXPECT_EQ(ptr2.get(), nullptr);
+    EXPECT_EQ(ptr3.use_count(), 2);
+
+    ptr3 = ptr1;
+    EXPECT_EQ(ptr1.use_count(), 2);
+
+    ptr1.reset();
+    ptr3.reset();
+    EXPECT_EQ(Node::counter, 0);
+}
+
+
+TEST(IntrusivePtrTest, ConvertingConstructor) {
+    IntrusivePtr<DerivedNode> derived = make_intrusive<DerivedNode>(7);
+    IntrusivePtr<Node> base(derived);
+    EXPECT_EQ(base.use_count(), 2);
+    EXPECT_EQ(base->value_, 7);
+}
+
+
+TEST(IntrusivePtrTest, RawPointerRoundTrip) {
+    IntrusivePtr<Node> ptr = make_intrusive<Node>(3);
+    Node* raw = ptr.release();
+    EXPECT_EQ(raw->RefCount(), 1);
+
+    IntrusivePtr<Node> adopted(raw, false);
+    EXPECT_EQ(adopted.use_count(), 1);
+
+    IntrusivePtr<Node> shared(raw);
+    EXPECT_EQ(adopted.use_count(), 2);
+}
+
+
+TEST(IntrusivePtrTest, FromUniquePtr) {
+    UniquePtr<Node> unique(new Node(5));
+    const Node* raw = unique.get();
+
+    IntrusivePtr<Node> ptr(std::move(unique));
+    EXPECT_EQ(unique.get(), nullptr);
+    EXPECT_EQ(ptr.get(), raw);
+    EXPECT_EQ(ptr.use_count(), 1);
+    EXPECT_EQ(Node::counter, 1);
+
+    ptr.reset();
+    EXPECT_EQ(Node::counter, 0);
+}
+
+
+TEST(IntrusivePtrTest, AtomicCounting) {
+    IntrusivePtr<AtomicNode> ptr = make_intrusive<AtomicNode>();
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&ptr] {
+            for (int j = 0; j < 10000; ++j) {
+                IntrusivePtr<AtomicNode> copy(ptr);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    EXPECT_EQ(ptr.use_count(), 1);
+    ptr.reset();
+    EXPECT_EQ(AtomicNode::counter, 0);
+}
+
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
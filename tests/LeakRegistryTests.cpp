@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "../include/SharedPtr.hpp"
+#include "../include/WeakPtr.hpp"
+
+struct GraphNode {
+    static int alive;
+    SharedPtr<GraphNode> next_;
+    std::vector<SharedPtr<GraphNode>> children_;
+
+    GraphNode() {
+        ++alive;
+    }
+
+    ~GraphNode() {
+        --alive;
+    }
+
+    template <typename Visitor>
+    void TraceRefs(Visitor& visit) const {
+        visit(next_);
+        for (const SharedPtr<GraphNode>& child : children_) {
+            visit(child);
+        }
+    }
+};
+
+int GraphNode::alive = 0;
+
+struct Opaque {
+    SharedPtr<GraphNode> hidden_;
+};
+
+
+TEST(LeakRegistryTest, ReportsLiveBlocks) {
+    SharedPtr<GraphNode> node = make_shared<GraphNode>();
+    SharedPtr<GraphNode> copy(node);
+
+    std::ostringstream report;
+    EXPECT_EQ(LeakRegistry::Report(report), 1u);
+    EXPECT_NE(report.str().find("GraphNode"), std::string::npos);
+    EXPECT_NE(report.str().find("use_count 2"), std::string::npos);
+
+    node = SharedPtr<GraphNode>();
+    copy = SharedPtr<GraphNode>();
+    EXPECT_TRUE(LeakRegistry::LiveBlocks().empty());
+}
+
+TEST(LeakRegistryTest, CollectsUnreachableCycle) {
+    WeakPtr<GraphNode> watcher;
+    {
+        SharedPtr<GraphNode> first = make_shared<GraphNode>();
+        SharedPtr<GraphNode> second(new GraphNode());
+        first->next_ = second;
+        second->next_ = first;
+        // A tail hanging off the cycle is garbage too
+        second->children_.push_back(make_shared<GraphNode>());
+        watcher = first;
+    }
+    EXPECT_EQ(GraphNode::alive, 3);
+    EXPECT_EQ(LeakRegistry::CollectCycles(), 3u);
+    EXPECT_EQ(GraphNode::alive, 0);
+    EXPECT_TRUE(watcher.expired());
+    EXPECT_TRUE(LeakRegistry::LiveBlocks().empty());
+}
+
+TEST(LeakRegistryTest, KeepsReachableGraphs) {
+    SharedPtr<GraphNode> root = make_shared<GraphNode>();
+    {
+        SharedPtr<GraphNode> other = make_shared<GraphNode>();
+        root->next_ = other;
+        other->next_ = root;
+        other->children_.push_back(make_shared<GraphNode>());
+    }
+    EXPECT_EQ(LeakRegistry::CollectCycles(), 0u);
+    EXPECT_EQ(GraphNode::alive, 3);
+
+    // Breaking the external reference turns the same graph into garbage
+    root = SharedPtr<GraphNode>();
+    EXPECT_EQ(LeakRegistry::CollectCycles(), 3u);
+    EXPECT_EQ(GraphNode::alive, 0);
+}
+
+TEST(LeakRegistryTest, UntracedOwnersKeepTargetsAlive) {
+    SharedPtr<Opaque> opaque = make_shared<Opaque>();
+    opaque->hidden_ = make_shared<GraphNode>();
+    opaque->hidden_->next_ = opaque->hidden_;
+    EXPECT_EQ(LeakRegistry::CollectCycles(), 0u);
+    EXPECT_EQ(GraphNode::alive, 1);
+
+    opaque->hidden_->next_ = SharedPtr<GraphNode>();
+    opaque = SharedPtr<Opaque>();
+    EXPECT_EQ(GraphNode::alive, 0);
+}
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
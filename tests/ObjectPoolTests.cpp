@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/ObjectPool.hpp"
+#include "../include/SharedPtr.hpp"
+#include "../include/UniquePtr.hpp"
+#include "../include/WeakPtr.hpp"
+
+struct Buffer {
+    static int constructed;
+    static int alive;
+    std::string name_;
+    std::vector<int> data_;
+
+    Buffer() {
+        constructed++;
+        alive++;
+    }
+
+    ~Buffer() {
+        alive--;
+    }
+};
+
+int Buffer::constructed = 0;
+int Buffer::alive = 0;
+
+void ClearBuffer(Buffer& buffer) {
+    buffer.name_.clear();
+    buffer.data_.clear();
+}
+
+
+TEST(ObjectPoolTest, SharedReturnsObjectToPool) {
+    Buffer::constructed = 0;
+    ObjectPool<Buffer> pool([] { return new Buffer(); }, ClearBuffer);
+
+    const Buffer* first = nullptr;
+    {
+        SharedPtr<Buffer> buffer = pool.acquire();
+        SharedPtr<Buffer> copy(buffer);
+        buffer->data_.assign(1000, 7);
+        first = buffer.get();
+        EXPECT_EQ(pool.idle(), 0u);
+    }
+    EXPECT_EQ(pool.idle(), 1u);
+
+    // The same object comes back, reset but with its capacity kept
+    SharedPtr<Buffer> again = pool.acquire();
+    EXPECT_EQ(again.get(), first);
+    EXPECT_TRUE(again->data_.empty());
+    EXPECT_GE(again->data_.capacity(), 1000u);
+    EXPECT_EQ(Buffer::constructed, 1);
+}
+
+TEST(ObjectPoolTest, UniqueReturnsObjectToPool) {
+    Buffer::constructed = 0;
+    ObjectPool<Buffer> pool;
+    pool.reserve(2);
+    EXPECT_EQ(pool.idle(), 2u);
+
+    ObjectPool<Buffer>::Unique first = pool.acquire_unique();
+    ObjectPool<Buffer>::Unique second = pool.acquire_unique();
+    ObjectPool<Buffer>::Unique third = pool.acquire_unique();
+    EXPECT_EQ(Buffer::constructed, 3);
+
+    second.reset();
+    third = ObjectPool<Buffer>::Unique();
+    EXPECT_EQ(pool.idle(), 2u);
+    EXPECT_EQ(Buffer::alive, 3);
+}
+
+TEST(ObjectPoolTest, MaxIdleDeletesSurplus) {
+    Buffer::alive = 0;
+    ObjectPool<Buffer> pool([] { return new Buffer(); }, {}, 1);
+    {
+        SharedPtr<Buffer> first = pool.acquire();
+        SharedPtr<Buffer> second = pool.acquire();
+        EXPECT_EQ(Buffer::alive, 2);
+    }
+    EXPECT_EQ(pool.idle(), 1u);
+    EXPECT_EQ(Buffer::alive, 1);
+}
+
+TEST(ObjectPoolTest, ThrowingResetDeletesObject) {
+    Buffer::alive = 0;
+    ObjectPool<Buffer> pool([] { return new Buffer(); }, [](Buffer&) { throw std::runtime_error("reset"); });
+    pool.acquire();
+    EXPECT_EQ(pool.idle(), 0u);
+    EXPECT_EQ(Buffer::alive, 0);
+}
+
+TEST(ObjectPoolTest, ObjectsOutliveThePool) {
+    Buffer::alive = 0;
+    SharedPtr<Buffer> kept;
+    WeakPtr<Buffer> watcher;
+    {
+        ObjectPool<Buffer> pool;
+        pool.reserve(3);
+        kept = pool.acquire();
+        watcher = kept;
+    }
+    EXPECT_EQ(Buffer::alive, 1);
+    kept = SharedPtr<Buffer>();
+    EXPECT_EQ(Buffer::alive, 0);
+    EXPECT_TRUE(watcher.expired());
+}
+
+TEST(ObjectPoolTest, ReleasedFromOtherThreads) {
+    Buffer::alive = 0;
+    ObjectPool<Buffer, AtomicPolicy> pool;
+    std::vector<SharedPtr<Buffer, AtomicPolicy>> buffers;
+    for (int i = 0; i < 8; ++i) {
+        buffers.push_back(pool.acquire());
+    }
+    std::vector<std::thread> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back([&buffers, i] {
+            buffers[i * 2] = SharedPtr<Buffer, AtomicPolicy>();
+            buffers[i * 2 + 1] = SharedPtr<Buffer, AtomicPolicy>();
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    EXPECT_EQ(pool.idle(), 8u);
+    EXPECT_EQ(Buffer::alive, 8);
+}
+
+
+TEST(ObjectPoolTest, NullFactoryThrows) {
+    ObjectPool<Buffer> pool([]() -> Buffer* { return nullptr; });
+    EXPECT_THROW(pool.acquire(), std::bad_alloc);
+    EXPECT_THROW(pool.acquire_unique(), std::bad_alloc);
+    EXPECT_THROW(pool.reserve(1), std::bad_alloc);
+    EXPECT_EQ(pool.idle(), 0u);
+}
+
+TEST(ObjectPoolTest, ReserveHonoursMaxIdle) {
+    Buffer::alive = 0;
+    ObjectPool<Buffer> pool([] { return new Buffer(); }, {}, 2);
+    pool.reserve(5);
+    EXPECT_EQ(pool.idle(), 2u);
+    EXPECT_EQ(Buffer::alive, 2);
+    pool.reserve(1);
+    EXPECT_EQ(pool.idle(), 2u);
+    EXPECT_EQ(Buffer::alive, 2);
+}
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
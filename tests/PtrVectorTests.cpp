@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <string>
+#include "../include/PtrVector.hpp"
+#include "../include/SharedPtr.hpp"
+#include "../include/WeakPtr.hpp"
+#include "../include/UniquePtr.hpp"
+#include "../include/IntrusivePtr.hpp"
+#include "../include/CompactSharedPtr.hpp"
+
+struct Item {
+    static int alive;
+    int value_;
+
+    explicit Item(int value = 0) : value_(value) {
+        alive++;
+    }
+
+    ~Item() {
+        alive--;
+    }
+};
+
+int Item::alive = 0;
+
+struct StatefulDeleter {
+    std::string tag_;
+
+    void operator()(Item* ptr) const {
+        delete ptr;
+    }
+};
+
+
+TEST(PtrVectorTest, RelocatableTrait) {
+    static_assert(is_trivially_relocatable_v<int*>);
+    static_assert(is_trivially_relocatable_v<SharedPtr<Item>>);
+    static_assert(is_trivially_relocatable_v<SharedPtr<Item, AtomicPolicy>>);
+    static_assert(is_trivially_relocatable_v<WeakPtr<Item>>);
+    static_assert(is_trivially_relocatable_v<UniquePtr<Item>>);
+    static_assert(is_trivially_relocatable_v<UniquePtr<Item[]>>);
+    static_assert(is_trivially_relocatable_v<CompactSharedPtr<Item>>);
+    static_assert(!is_trivially_relocatable_v<UniquePtr<Item, StatefulDeleter>>);
+}
+
+TEST(PtrVectorTest, GrowthRelocatesWithoutTouchingCounts) {
+    SharedPtr<Item> first = make_shared<Item>(1);
+    {
+        PtrVector<SharedPtr<Item>> items;
+        items.push_back(first);
+        for (int i = 0; i < 1000; ++i) {
+            items.push_back(make_shared<Item>(i));
+        }
+        EXPECT_EQ(items.size(), 1001u);
+        EXPECT_GE(items.capacity(), 1001u);
+        EXPECT_EQ(first.use_count(), 2u);
+        EXPECT_EQ(items[500]->value_, 499);
+        EXPECT_EQ(Item::alive, 1001);
+    }
+    EXPECT_EQ(first.use_count(), 1u);
+    EXPECT_EQ(Item::alive, 1);
+}
+
+TEST(PtrVectorTest, PushBackOwnElement) {
+    PtrVector<SharedPtr<Item>> items;
+    items.push_back(make_shared<Item>(7));
+    while (items.size() < items.capacity()) {
+        items.push_back(items[0]);
+    }
+    // Growth happens here while the argument still lives in the old buffer
+    items.push_back(items[0]);
+    EXPECT_EQ(items.back()->value_, 7);
+    EXPECT_EQ(items[0].use_count(), items.size());
+}
+
+TEST(PtrVectorTest, EraseAndResize) {
+    PtrVector<UniquePtr<Item>> items;
+    for (int i = 0; i < 10; ++i) {
+        items.emplace_back(new Item(i));
+    }
+
+    auto next = items.erase(items.begin() + 2, items.begin() + 5);
+    EXPECT_EQ((*next)->value_, 5);
+    EXPECT_EQ(items.size(), 7u);
+    EXPECT_EQ(Item::alive, 7);
+
+    items.erase(items.begin());
+    EXPECT_EQ(items[0]->value_, 1);
+    EXPECT_EQ(items[1]->value_, 5);
+
+    items.resize(3);
+    EXPECT_EQ(Item::alive, 3);
+    items.resize(5);
+    EXPECT_EQ(items[4].get(), nullptr);
+    EXPECT_THROW(items.at(5), std::out_of_range);
+
+    items.pop_back();
+    items.clear();
+    EXPECT_TRUE(items.empty());
+    EXPECT_EQ(Item::alive, 0);
+}
+
+TEST(PtrVectorTest, CopyAndMove) {
+    PtrVector<SharedPtr<Item>> items;
+    items.push_back(make_shared<Item>(1));
+    items.push_back(make_shared<Item>(2));
+
+    PtrVector<SharedPtr<Item>> copy(items);
+    EXPECT_EQ(items[1].use_count(), 2u);
+
+    PtrVector<SharedPtr<Item>> moved(std::move(items));
+    EXPECT_TRUE(items.empty());
+    EXPECT_EQ(moved[1].use_count(), 2u);
+
+    copy = moved;
+    EXPECT_EQ(moved[0].use_count(), 2u);
+    copy = PtrVector<SharedPtr<Item>>();
+    EXPECT_EQ(moved[0].use_count(), 1u);
+}
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -1,6 +1,30 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <iterator>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
 #include "../include/SharedPtr.hpp"
+#include "../include/WeakPtr.hpp"
+#include "../include/EnableSharedFromThis.hpp"
+
+
+constinit SharedPtr<int> global_empty_ptr_;
+static_assert(std::is_nothrow_default_constructible_v<SharedPtr<int>>);
+
+
+// Counts its destructions; atomic, so it may die on any thread
+struct Tracked {
+    std::atomic<int>* destroyed_;
+
+    explicit Tracked(std::atomic<int>* destroyed) : destroyed_(destroyed) {}
+
+    ~Tracked() {
+        destroyed_->fetch_add(1);
+    }
+};
 
 
 TEST(SharedPtrTest, DefaultConstructor) {
@@ -9,6 +33,24 @@ TEST(SharedPtrTest, DefaultConstructor) {
     EXPECT_EQ(ptr_.use_count(), 0);
 }
 
+TEST(SharedPtrTest, EmptyPointersHaveNoControlBlock) {
+    EXPECT_EQ(global_empty_ptr_.use_count(), 0);
+
+    std::vector<SharedPtr<int>> ptrs_(1000);
+    for (const auto& ptr_ : ptrs_) {
+        EXPECT_EQ(ptr_.get(), nullptr);
+        EXPECT_EQ(ptr_.use_count(), 0);
+    }
+
+    SharedPtr<int> null_(nullptr);
+    SharedPtr<int> copy_(null_);
+    EXPECT_EQ(copy_.use_count(), 0);
+
+    WeakPtr<int> weak_(copy_);
+    EXPECT_TRUE(weak_.expired());
+    EXPECT_EQ(weak_.lock().get(), nullptr);
+}
+
 TEST(SharedPtrTest, PtrConstructor) {
     int* raw_ptr_ = new int(1999);
     SharedPtr<int> ptr_(raw_ptr_);
@@ -110,6 +152,129 @@ TEST(SharedPtrTest, ResetMethod) {
 }
 
 
+TEST(SharedPtrTest, ResetReleasesOwnership) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked> ptr_(new Tracked(&destroyed_));
+    SharedPtr<Tracked> other_(ptr_);
+
+    // Shared block: the new object gets a block of its own, the old one survives in other_
+    ptr_.reset(new Tracked(&destroyed_));
+    EXPECT_FALSE(ptr_.owner_equal(other_));
+    EXPECT_EQ(other_.use_count(), 1);
+    EXPECT_EQ(destroyed_.load(), 0);
+
+    // Unique block: the old object is destroyed and the block is kept for the new one
+    ptr_.reset(new Tracked(&destroyed_));
+    EXPECT_EQ(destroyed_.load(), 1);
+    EXPECT_EQ(ptr_.use_count(), 1);
+
+    ptr_.reset();
+    other_.reset();
+    EXPECT_EQ(destroyed_.load(), 3);
+    EXPECT_FALSE(ptr_);
+    EXPECT_EQ(ptr_.use_count(), 0);
+}
+
+
+TEST(SharedPtrTest, ResetKeepsObservedBlock) {
+    SharedPtr<int> ptr_(new int(1));
+    WeakPtr<int> weak_(ptr_);
+    ptr_.reset(new int(2));
+    EXPECT_TRUE(weak_.expired());
+    EXPECT_EQ(*ptr_, 2);
+}
+
+
+// Non-virtual destructor on purpose: only deleting through the real type runs ~DerivedTracked
+struct BaseTracked {
+    int value_ = 0;
+};
+
+struct DerivedTracked : BaseTracked {
+    Tracked tracked_;
+
+    explicit DerivedTracked(std::atomic<int>* destroyed) : tracked_(destroyed) {}
+};
+
+TEST(SharedPtrTest, ResetDeletesThroughRealType) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<BaseTracked> ptr_(new BaseTracked());
+    ptr_.reset(new DerivedTracked(&destroyed_));
+    ptr_.reset(new DerivedTracked(&destroyed_));
+    EXPECT_EQ(destroyed_.load(), 1);
+    ptr_.reset(new BaseTracked());
+    EXPECT_EQ(destroyed_.load(), 2);
+    ptr_.reset();
+    EXPECT_FALSE(ptr_);
+}
+
+
+TEST(SharedPtrTest, ResetEmplace) {
+    SharedPtr<std::string> ptr_ = make_shared<std::string>("first");
+    const std::string* storage_ = ptr_.get();
+
+    EXPECT_EQ(ptr_.reset_emplace(3, 'x'), "xxx");
+    EXPECT_EQ(ptr_.get(), storage_);
+    EXPECT_EQ(ptr_.use_count(), 1);
+
+    // Not reusable while shared: falls back to a fresh make_shared
+    SharedPtr<std::string> copy_(ptr_);
+    ptr_.reset_emplace("second");
+    EXPECT_NE(ptr_.get(), copy_.get());
+    EXPECT_EQ(*copy_, "xxx");
+    EXPECT_EQ(*ptr_, "second");
+
+    SharedPtr<std::string> empty_;
+    EXPECT_EQ(empty_.reset_emplace("made"), "made");
+}
+
+
+struct Fragile {
+    static int alive;
+
+    explicit Fragile(bool fail) {
+        if (fail) {
+            throw std::runtime_error("construction failed");
+        }
+        ++alive;
+    }
+
+    ~Fragile() {
+        --alive;
+    }
+};
+
+int Fragile::alive = 0;
+
+
+TEST(SharedPtrTest, ResetEmplaceThrowing) {
+    SharedPtr<Fragile> ptr_ = make_shared<Fragile>(false);
+    const Fragile* storage_ = ptr_.get();
+    EXPECT_THROW(ptr_.reset_emplace(true), std::runtime_error);
+    EXPECT_EQ(ptr_.get(), storage_);
+    EXPECT_EQ(Fragile::alive, 1);
+    ptr_ = SharedPtr<Fragile>();
+    EXPECT_EQ(Fragile::alive, 0);
+}
+
+TEST(SharedPtrTest, ResetEmplaceFromOwnObject) {
+    SharedPtr<std::string> ptr_ = make_shared<std::string>("a string long enough to live on the heap");
+    const std::string* storage_ = ptr_.get();
+    EXPECT_EQ(ptr_.reset_emplace(*ptr_ + " twice"), "a string long enough to live on the heap twice");
+    EXPECT_EQ(ptr_.reset_emplace(*ptr_), "a string long enough to live on the heap twice");
+    EXPECT_EQ(ptr_.get(), storage_);
+}
+
+
+TEST(SharedPtrTest, Swap) {
+    SharedPtr<int> first_(new int(1));
+    SharedPtr<int> second_(new int(2));
+    first_.swap(second_);
+    EXPECT_EQ(*first_, 2);
+    EXPECT_EQ(*second_, 1);
+}
+
+
 
 TEST(SharedPtrTest, Destructor) {
     int* raw_ptr_ = new int(42);
@@ -140,6 +305,525 @@ TEST(SharedPtrTest, ReferenceCounting) {
 }
 
 
+TEST(SharedPtrTest, MakeShared) {
+    SharedPtr<std::pair<int, double>> ptr_ = make_shared<std::pair<int, double>>(7, 2.5);
+
+    EXPECT_EQ(ptr_.use_count(), 1);
+    EXPECT_EQ(ptr_->first, 7);
+    EXPECT_EQ(ptr_->second, 2.5);
+}
+
+
+TEST(SharedPtrTest, MakeSharedDestroysObject) {
+    std::atomic<int> destroyed_{0};
+    {
+        SharedPtr<Tracked> ptr_1_ = ::make_shared<Tracked>(&destroyed_);
+        SharedPtr<Tracked> ptr_2_(ptr_1_);
+        EXPECT_EQ(ptr_1_.use_count(), 2);
+    }
+
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+TEST(SharedPtrTest, AtomicPolicyConcurrentCopies) {
+    std::atomic<int> destroyed_{0};
+    {
+        SharedPtr<Tracked, AtomicPolicy> ptr_ = ::make_shared<Tracked, AtomicPolicy>(&destroyed_);
+
+        std::vector<std::thread> threads_;
+        for (int i = 0; i < 4; ++i) {
+            threads_.emplace_back([&ptr_] {
+                for (int j = 0; j < 10000; ++j) {
+                    SharedPtr<Tracked, AtomicPolicy> copy_(ptr_);
+                }
+            });
+        }
+        for (auto& thread_ : threads_) {
+            thread_.join();
+        }
+
+        EXPECT_EQ(ptr_.use_count(), 1);
+        EXPECT_EQ(destroyed_.load(), 0);
+    }
+
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+template <typename T>
+struct CountingAllocator {
+    using value_type = T;
+
+    int* allocations_;
+
+    explicit CountingAllocator(int* allocations) : allocations_(allocations) {}
+
+    template <typename U>
+    CountingAllocator(const CountingAllocator<U>& other) : allocations_(other.allocations_) {}
+
+    T* allocate(size_t n) {
+        ++*allocations_;
+        return std::allocator<T>().allocate(n);
+    }
+
+    void deallocate(T* ptr, size_t n) {
+        --*allocations_;
+        std::allocator<T>().deallocate(ptr, n);
+    }
+};
+
+
+TEST(SharedPtrTest, AllocateShared) {
+    int allocations_ = 0;
+    {
+        SharedPtr<std::pair<int, int>> ptr_1_ = allocate_shared<std::pair<int, int>>(CountingAllocator<char>(&allocations_), 1, 2);
+        EXPECT_EQ(allocations_, 1);
+        EXPECT_EQ(ptr_1_->second, 2);
+
+        SharedPtr<std::pair<int, int>> ptr_2_(ptr_1_);
+        EXPECT_EQ(ptr_2_.use_count(), 2);
+    }
+
+    EXPECT_EQ(allocations_, 0);
+}
+
+
+TEST(SharedPtrTest, BlockPoolReusesFreedBlocks) {
+    void* block_1_ = BlockPool::Allocate(40);
+    BlockPool::Deallocate(block_1_, 40);
+
+    void* block_2_ = BlockPool::Allocate(48);
+    EXPECT_EQ(block_1_, block_2_);
+    BlockPool::Deallocate(block_2_, 48);
+}
+
+
+TEST(SharedPtrTest, CustomDeleter) {
+    int deleted_ = 0;
+    int value_ = 42;
+    {
+        SharedPtr<int> ptr_1_(&value_, [&deleted_](int*) { ++deleted_; });
+        SharedPtr<int> ptr_2_(ptr_1_);
+        EXPECT_EQ(*ptr_2_, 42);
+        EXPECT_EQ(ptr_2_.use_count(), 2);
+    }
+
+    EXPECT_EQ(deleted_, 1);
+}
+
+
+TEST(SharedPtrTest, CustomDeleterAndAllocator) {
+    int allocations_ = 0;
+    int deleted_ = 0;
+    {
+        SharedPtr<int> ptr_(new int(7), [&deleted_](int* raw_ptr_) { ++deleted_; delete raw_ptr_; }, CountingAllocator<int>(&allocations_));
+        EXPECT_EQ(allocations_, 1);
+        EXPECT_EQ(*ptr_, 7);
+    }
+
+    EXPECT_EQ(deleted_, 1);
+    EXPECT_EQ(allocations_, 0);
+}
+
+
+TEST(SharedPtrTest, AliasingConstructor) {
+    struct Buffer {
+        int header_;
+        double payload_[4];
+    };
+
+    SharedPtr<Buffer> owner_ = make_shared<Buffer>(Buffer{1, {0.5, 1.5, 2.5, 3.5}});
+    SharedPtr<double> slice_(owner_, &owner_->payload_[2]);
+
+    EXPECT_EQ(*slice_, 2.5);
+    EXPECT_EQ(owner_.use_count(), 2);
+    EXPECT_EQ(slice_.use_count(), 2);
+
+    int* raw_header_ = &owner_->header_;
+    SharedPtr<int> header_(std::move(owner_), raw_header_);
+    EXPECT_EQ(owner_.get(), nullptr);
+    EXPECT_EQ(*header_, 1);
+    EXPECT_EQ(slice_.use_count(), 2);
+}
+
+
+TEST(SharedPtrTest, AliasingOutlivesOwner) {
+    struct Pair {
+        std::string first_;
+        std::string second_;
+    };
+
+    SharedPtr<std::string> second_;
+    {
+        SharedPtr<Pair> owner_ = make_shared<Pair>(Pair{"first", "second"});
+        std::string* raw_second_ = &owner_->second_;
+        second_ = SharedPtr<std::string>(std::move(owner_), raw_second_);
+    }
+
+    EXPECT_EQ(*second_, "second");
+    EXPECT_EQ(second_.use_count(), 1);
+}
+
+
+struct Base {
+    virtual ~Base() = default;
+    int base_value_ = 1;
+};
+
+struct Derived : Base {
+    int derived_value_ = 2;
+};
+
+struct Other : Base {};
+
+
+TEST(SharedPtrTest, ConvertingConstructors) {
+    SharedPtr<Derived> derived_ = make_shared<Derived>();
+    SharedPtr<Base> base_(derived_);
+    EXPECT_EQ(base_.use_count(), 2);
+    EXPECT_EQ(base_->base_value_, 1);
+
+    SharedPtr<Base> moved_(std::move(derived_));
+    EXPECT_EQ(derived_.get(), nullptr);
+    EXPECT_EQ(moved_.use_count(), 2);
+
+    SharedPtr<Base> from_raw_(new Derived());
+    EXPECT_EQ(from_raw_.use_count(), 1);
+}
+
+
+TEST(SharedPtrTest, PointerCasts) {
+    SharedPtr<Base> base_ = make_shared<Derived>();
+
+    SharedPtr<Derived> derived_ = static_pointer_cast<Derived>(base_);
+    EXPECT_EQ(derived_->derived_value_, 2);
+    EXPECT_EQ(base_.use_count(), 2);
+
+    SharedPtr<Derived> dynamic_ = dynamic_pointer_cast<Derived>(base_);
+    EXPECT_EQ(dynamic_.get(), derived_.get());
+    EXPECT_EQ(base_.use_count(), 3);
+
+    SharedPtr<Other> failed_ = dynamic_pointer_cast<Other>(base_);
+    EXPECT_EQ(failed_.get(), nullptr);
+    EXPECT_EQ(base_.use_count(), 3);
+
+    SharedPtr<const Base> const_base_(base_);
+    SharedPtr<Base> mutable_base_ = const_pointer_cast<Base>(const_base_);
+    EXPECT_EQ(mutable_base_.use_count(), 5);
+}
+
+
+TEST(SharedPtrTest, MovePointerCastsKeepCount) {
+    SharedPtr<Base> base_ = make_shared<Derived>();
+    SharedPtr<Base> observer_(base_);
+
+    SharedPtr<Derived> derived_ = static_pointer_cast<Derived>(std::move(base_));
+    EXPECT_EQ(base_.get(), nullptr);
+    EXPECT_EQ(derived_.use_count(), 2);
+
+    SharedPtr<Other> failed_ = dynamic_pointer_cast<Other>(std::move(derived_));
+    EXPECT_EQ(failed_.get(), nullptr);
+    EXPECT_NE(derived_.get(), nullptr);
+    EXPECT_EQ(derived_.use_count(), 2);
+}
+
+
+TEST(SharedPtrTest, BiasedPolicy) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, BiasedPolicy> ptr_(new Tracked(&destroyed_));
+    SharedPtr<Tracked, BiasedPolicy> owner_copy_(ptr_);
+    EXPECT_EQ(ptr_.use_count(), 2);
+
+    std::vector<std::thread> threads_;
+    std::vector<SharedPtr<Tracked, BiasedPolicy>> escaped_(4);
+    for (int i = 0; i < 4; ++i) {
+        threads_.emplace_back([&ptr_, &escaped_, i] {
+            for (int j = 0; j < 10000; ++j) {
+                SharedPtr<Tracked, BiasedPolicy> copy_(ptr_);
+            }
+            escaped_[i] = ptr_;
+        });
+    }
+    for (auto& thread_ : threads_) {
+        thread_.join();
+    }
+    EXPECT_EQ(ptr_.use_count(), 6);
+
+    // The owner lets go first; the foreign copies keep the object alive after the merge
+    ptr_ = SharedPtr<Tracked, BiasedPolicy>();
+    owner_copy_ = SharedPtr<Tracked, BiasedPolicy>();
+    EXPECT_EQ(destroyed_.load(), 0);
+    EXPECT_EQ(escaped_[0].use_count(), 4);
+
+    std::thread last_([&escaped_] {
+        escaped_.clear();
+    });
+    last_.join();
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+TEST(SharedPtrTest, BiasedPolicyForeignDropsFirst) {
+    std::atomic<int> destroyed_{0};
+    {
+        SharedPtr<Tracked, BiasedPolicy> ptr_ = ::make_shared<Tracked, BiasedPolicy>(&destroyed_);
+        std::thread foreign_([ptr_]() mutable {
+            SharedPtr<Tracked, BiasedPolicy> copy_(ptr_);
+            ptr_ = SharedPtr<Tracked, BiasedPolicy>();
+        });
+        foreign_.join();
+        EXPECT_EQ(ptr_.use_count(), 1);
+        EXPECT_EQ(destroyed_.load(), 0);
+    }
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+TEST(SharedPtrTest, BiasedPolicyQueuedMerge) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, BiasedPolicy> handed_(new Tracked(&destroyed_));
+    std::thread foreign_([moved_ = std::move(handed_)]() mutable {
+        moved_ = SharedPtr<Tracked, BiasedPolicy>();
+    });
+    foreign_.join();
+    // The only reference was owner-made and dropped abroad; the owner's next count update merges it
+    EXPECT_EQ(destroyed_.load(), 0);
+    SharedPtr<int, BiasedPolicy> unrelated_(new int(0));
+    SharedPtr<int, BiasedPolicy> unrelated_copy_(unrelated_);
+    EXPECT_EQ(destroyed_.load(), 1);
+
+    // An exiting owner merges whatever is queued, and later drops merge on their own
+    SharedPtr<Tracked, BiasedPolicy> orphan_;
+    std::thread owner_([&orphan_, &destroyed_] {
+        orphan_ = SharedPtr<Tracked, BiasedPolicy>(new Tracked(&destroyed_));
+    });
+    owner_.join();
+    EXPECT_EQ(orphan_.use_count(), 1);
+    orphan_ = SharedPtr<Tracked, BiasedPolicy>();
+    EXPECT_EQ(destroyed_.load(), 2);
+}
+
+
+TEST(SharedPtrTest, BiasedPolicyProducerReclaims) {
+    std::atomic<int> destroyed_{0};
+    std::vector<SharedPtr<Tracked, BiasedPolicy>> batch_;
+    for (int i = 0; i < 1000; ++i) {
+        batch_.push_back(SharedPtr<Tracked, BiasedPolicy>(new Tracked(&destroyed_)));
+    }
+    std::thread consumer_([moved_ = std::move(batch_)]() mutable {
+        moved_.clear();
+    });
+    consumer_.join();
+    EXPECT_EQ(destroyed_.load(), 0);
+
+    // A producer never drops a reference itself; making the next object merges the queue
+    SharedPtr<Tracked, BiasedPolicy> next_(new Tracked(&destroyed_));
+    EXPECT_EQ(destroyed_.load(), 1000);
+
+    // An idle producer merges at a safepoint instead
+    std::thread last_consumer_([moved_ = std::move(next_)]() mutable {
+        moved_ = SharedPtr<Tracked, BiasedPolicy>();
+    });
+    last_consumer_.join();
+    EXPECT_EQ(destroyed_.load(), 1000);
+    BiasedPolicy::MergeQueued();
+    EXPECT_EQ(destroyed_.load(), 1001);
+}
+
+
+TEST(SharedPtrTest, BiasedPolicyLockAfterQueuedHandOff) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, BiasedPolicy> ptr_(new Tracked(&destroyed_));
+    WeakPtr<Tracked, BiasedPolicy> weak_(ptr_);
+    SharedPtr<Tracked, BiasedPolicy> handed_(ptr_);
+    ptr_ = SharedPtr<Tracked, BiasedPolicy>();
+
+    // The last reference dies abroad: the count is zero while the merge waits in the queue
+    std::thread foreign_([moved_ = std::move(handed_)]() mutable {
+        moved_ = SharedPtr<Tracked, BiasedPolicy>();
+    });
+    foreign_.join();
+    EXPECT_TRUE(weak_.expired());
+
+    bool foreign_locked_ = true;
+    std::thread locker_([&weak_, &foreign_locked_] {
+        foreign_locked_ = static_cast<bool>(weak_.lock());
+    });
+    locker_.join();
+    EXPECT_FALSE(foreign_locked_);
+
+    EXPECT_FALSE(weak_.lock());
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+struct SelfOwned : EnableSharedFromThis<SelfOwned> {
+    int value_ = 0;
+
+    explicit SelfOwned(int value) : value_(value) {}
+
+    SharedPtr<SelfOwned> Self() {
+        return shared_from_this();
+    }
+};
+
+struct DerivedSelfOwned : SelfOwned {
+    DerivedSelfOwned() : SelfOwned(7) {}
+};
+
+
+TEST(SharedPtrTest, SharedFromThis) {
+    SharedPtr<SelfOwned> ptr_ = make_shared<SelfOwned>(3);
+    SharedPtr<SelfOwned> self_ = ptr_->Self();
+    EXPECT_TRUE(self_.owner_equal(ptr_));
+    EXPECT_EQ(ptr_.use_count(), 2);
+    EXPECT_EQ(self_->value_, 3);
+
+    const SelfOwned& const_ref_ = *ptr_;
+    SharedPtr<const SelfOwned> const_self_ = const_ref_.shared_from_this();
+    EXPECT_EQ(ptr_.use_count(), 3);
+    EXPECT_EQ(ptr_->weak_from_this().use_count(), 3);
+
+    SharedPtr<SelfOwned> raw_(new SelfOwned(4));
+    EXPECT_TRUE(raw_->shared_from_this().owner_equal(raw_));
+
+    bool deleted_ = false;
+    {
+        SharedPtr<SelfOwned> with_deleter_(new SelfOwned(5), [&deleted_](SelfOwned* p) {
+            deleted_ = true;
+            delete p;
+        });
+        EXPECT_EQ(with_deleter_->shared_from_this().use_count(), 2);
+    }
+    EXPECT_TRUE(deleted_);
+
+    // The base is found through a derived type, and the hook does not pin the object
+    WeakPtr<SelfOwned> weak_;
+    {
+        SharedPtr<SelfOwned> derived_(new DerivedSelfOwned());
+        EXPECT_TRUE(derived_->shared_from_this().owner_equal(derived_));
+        weak_ = derived_->weak_from_this();
+        EXPECT_EQ(derived_.use_count(), 1);
+    }
+    EXPECT_TRUE(weak_.expired());
+}
+
+
+TEST(SharedPtrTest, SharedFromThisUnowned) {
+    SelfOwned stack_(1);
+    EXPECT_THROW(stack_.shared_from_this(), std::bad_weak_ptr);
+    EXPECT_TRUE(stack_.weak_from_this().expired());
+
+    // A copy starts unowned instead of sharing the source's block
+    SharedPtr<SelfOwned> ptr_ = make_shared<SelfOwned>(2);
+    SelfOwned copy_(*ptr_);
+    EXPECT_THROW(copy_.shared_from_this(), std::bad_weak_ptr);
+}
+
+
+TEST(SharedPtrTest, ShareN) {
+    SharedPtr<int> ptr_ = make_shared<int>(5);
+    std::vector<SharedPtr<int>> copies_;
+    ptr_.share_n(100, std::back_inserter(copies_));
+    EXPECT_EQ(copies_.size(), 100u);
+    EXPECT_EQ(ptr_.use_count(), 101u);
+    EXPECT_EQ(*copies_[99], 5);
+    EXPECT_TRUE(copies_[42].owner_equal(ptr_));
+
+    SharedPtr<int> fixed_[3];
+    SharedPtr<int>* end_ = ptr_.share_n(3, fixed_);
+    EXPECT_EQ(end_, fixed_ + 3);
+    EXPECT_EQ(ptr_.use_count(), 104u);
+
+    SharedPtr<int> empty_;
+    empty_.share_n(2, fixed_);
+    EXPECT_FALSE(fixed_[0]);
+    EXPECT_EQ(ptr_.use_count(), 102u);
+}
+
+
+TEST(SharedPtrTest, ReleaseAll) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, AtomicPolicy> kept_ = ::make_shared<Tracked, AtomicPolicy>(&destroyed_);
+
+    // Interleaved blocks, more distinct ones than the grouping table has slots, and empty entries
+    std::vector<SharedPtr<Tracked, AtomicPolicy>> ptrs_;
+    std::vector<SharedPtr<Tracked, AtomicPolicy>> owners_;
+    for (int i = 0; i < 200; ++i) {
+        owners_.push_back(SharedPtr<Tracked, AtomicPolicy>(new Tracked(&destroyed_)));
+    }
+    for (int round = 0; round < 3; ++round) {
+        for (auto& owner_ : owners_) {
+            ptrs_.push_back(owner_);
+            ptrs_.push_back(kept_);
+        }
+        ptrs_.emplace_back();
+    }
+    owners_.clear();
+    EXPECT_EQ(destroyed_.load(), 0);
+    EXPECT_EQ(kept_.use_count(), 601u);
+
+    release_all(std::span(ptrs_));
+    EXPECT_EQ(destroyed_.load(), 200);
+    EXPECT_EQ(kept_.use_count(), 1u);
+    for (const auto& ptr : ptrs_) {
+        EXPECT_FALSE(ptr);
+    }
+}
+
+
+TEST(SharedPtrTest, BulkCountsWithBiasedPolicy) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, BiasedPolicy> ptr_(new Tracked(&destroyed_));
+    std::vector<SharedPtr<Tracked, BiasedPolicy>> copies_;
+    ptr_.share_n(10, std::back_inserter(copies_));
+    EXPECT_EQ(ptr_.use_count(), 11u);
+
+    // Released abroad: the owner-made references come back through the merge queue
+    std::thread foreign_([&copies_] {
+        release_all(std::span(copies_));
+    });
+    foreign_.join();
+    EXPECT_EQ(ptr_.use_count(), 1u);
+
+    release_all(std::span(&ptr_, 1));
+    EXPECT_EQ(destroyed_.load(), 1);
+}
+
+
+TEST(SharedPtrTest, StripedPolicyRetire) {
+    std::atomic<int> destroyed_{0};
+    SharedPtr<Tracked, StripedPolicy> ptr_(new Tracked(&destroyed_));
+    WeakPtr<Tracked, StripedPolicy> weak_(ptr_);
+    std::vector<std::thread> threads_;
+    std::vector<SharedPtr<Tracked, StripedPolicy>> kept_(4);
+    for (int i = 0; i < 4; ++i) {
+        threads_.emplace_back([&ptr_, &kept_, i] {
+            for (int j = 0; j < 10000; ++j) {
+                SharedPtr<Tracked, StripedPolicy> copy_(ptr_);
+            }
+            kept_[i] = ptr_;
+        });
+    }
+    for (auto& thread_ : threads_) {
+        thread_.join();
+    }
+    EXPECT_EQ(ptr_.use_count(), 5u);
+
+    // A second retire() is a no-op; afterwards the last owner frees the object
+    ptr_.retire();
+    ptr_.retire();
+    EXPECT_EQ(ptr_.use_count(), 5u);
+    EXPECT_TRUE(weak_.lock());
+    ptr_ = SharedPtr<Tracked, StripedPolicy>();
+    EXPECT_EQ(destroyed_.load(), 0);
+    kept_.clear();
+    EXPECT_EQ(destroyed_.load(), 1);
+    EXPECT_FALSE(weak_.lock());
+}
+
+
 int main(int argc, char** argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
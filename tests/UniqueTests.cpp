@@ -1,4 +1,5 @@
 #include <gtest/gtest.h>
+#include <cstdio>
 #include "../include/UniquePtr.hpp"
 
 class TestClass {
@@ -108,6 +109,128 @@ TEST(UniquePtrTest, ComparisonOperators) {
 
 
 
+struct CountingDeleter {
+    int* calls;
+
+    void operator()(int* ptr) const {
+        ++*calls;
+        delete ptr;
+    }
+};
+
+struct FileCloser {
+    void operator()(std::FILE* file) const noexcept {
+        std::fclose(file);
+    }
+};
+
+
+static_assert(sizeof(UniquePtr<int>) == sizeof(int*));
+static_assert(sizeof(UniquePtr<std::FILE, FileCloser>) == sizeof(std::FILE*));
+// A function-pointer deleter has no usable default, so it must always be passed in
+static_assert(!std::is_constructible_v<UniquePtr<int, void (*)(int*)>, int*>);
+static_assert(!std::is_constructible_v<UniquePtr<int[], void (*)(int*)>, int*>);
+
+
+TEST(UniquePtrTest, CustomDeleter) {
+    int calls = 0;
+    {
+        UniquePtr<int, CountingDeleter> ptr(new int(42), CountingDeleter{&calls});
+        ptr.reset(new int(10));
+        EXPECT_EQ(calls, 1);
+        EXPECT_EQ(ptr.get_deleter().calls, &calls);
+    }
+    EXPECT_EQ(calls, 2);
+}
+
+
+TEST(UniquePtrTest, CustomDeleterMove) {
+    int calls = 0;
+    {
+        UniquePtr<int, CountingDeleter> ptr1(new int(42), CountingDeleter{&calls});
+        UniquePtr<int, CountingDeleter> ptr2(std::move(ptr1));
+        EXPECT_EQ(ptr1.get(), nullptr);
+        EXPECT_EQ(*ptr2, 42);
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+
+TEST(UniquePtrTest, StatelessDeleter) {
+    UniquePtr<std::FILE, FileCloser> file(std::tmpfile());
+    ASSERT_NE(file.get(), nullptr);
+    EXPECT_EQ(std::fputc('x', const_cast<std::FILE*>(file.get())), 'x');
+}
+
+
+void DeleteInt(int* ptr) {
+    delete ptr;
+}
+
+TEST(UniquePtrTest, FunctionPointerDeleter) {
+    UniquePtr<int, void (*)(int*)> ptr(new int(7), &DeleteInt);
+    EXPECT_EQ(*ptr, 7);
+    EXPECT_EQ(ptr.get_deleter(), &DeleteInt);
+}
+
+
+TEST(UniquePtrTest, ArrayDestructor) {
+    {
+        UniquePtr<TestClass[]> ptr(new TestClass[3]);
+        EXPECT_EQ(TestClass::counter, 3);
+    }
+    EXPECT_EQ(TestClass::counter, 0);
+}
+
+
+struct MoveOnlyArrayDeleter {
+    int* calls;
+
+    explicit MoveOnlyArrayDeleter(int* calls) : calls(calls) {}
+    MoveOnlyArrayDeleter(MoveOnlyArrayDeleter&&) = default;
+    MoveOnlyArrayDeleter& operator=(MoveOnlyArrayDeleter&&) = default;
+
+    void operator()(int* ptr) const {
+        ++*calls;
+        delete[] ptr;
+    }
+};
+
+TEST(UniquePtrTest, ArrayMoveOnlyDeleter) {
+    int calls = 0;
+    {
+        UniquePtr<int[], MoveOnlyArrayDeleter> ptr(new int[4], MoveOnlyArrayDeleter(&calls));
+        UniquePtr<int[], MoveOnlyArrayDeleter> moved(std::move(ptr));
+        EXPECT_EQ(ptr.get(), nullptr);
+    }
+    EXPECT_EQ(calls, 1);
+}
+
+
+TEST(UniquePtrTest, ArrayIndexing) {
+    UniquePtr<int[]> ptr = make_unique_array<int>(4);
+    for (int i = 0; i < 4; ++i) {
+        EXPECT_EQ(ptr[i], 0);
+        ptr[i] = i * 10;
+    }
+    EXPECT_EQ(ptr[3], 30);
+}
+
+
+TEST(UniquePtrTest, MakeUniqueForOverwrite) {
+    UniquePtr<char[]> buffer = make_unique_for_overwrite<char[]>(1 << 20);
+    ASSERT_TRUE(buffer);
+    buffer[0] = 'a';
+    buffer[(1 << 20) - 1] = 'z';
+    EXPECT_EQ(buffer[0], 'a');
+    EXPECT_EQ(buffer[(1 << 20) - 1], 'z');
+
+    UniquePtr<int> single = make_unique_for_overwrite<int>();
+    *single = 5;
+    EXPECT_EQ(*single, 5);
+}
+
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
@@ -1,8 +1,22 @@
 #include <gtest/gtest.h>
+#include <atomic>
+#include <thread>
 #include "../include/WeakPtr.hpp"
 #include "../include/SharedPtr.hpp"
 
 
+// Counts its destructions; atomic, so it may die on any thread
+struct Tracked {
+    std::atomic<int>* destroyed_;
+
+    explicit Tracked(std::atomic<int>* destroyed) : destroyed_(destroyed) {}
+
+    ~Tracked() {
+        destroyed_->fetch_add(1);
+    }
+};
+
+
 TEST(WeakPtrTest, DefaultConstructor) {
     WeakPtr<int> weakPtr;
     EXPECT_EQ(weakPtr.use_count(), 0);
@@ -80,7 +94,7 @@ TEST(WeakPtrTest, Expired) {
     SharedPtr<int> sharedPtr(new int(10));
     WeakPtr<int> weakPtr(sharedPtr);
     sharedPtr.reset();
-    EXPECT_FALSE(weakPtr.expired());
+    EXPECT_TRUE(weakPtr.expired());
 }
 
 TEST(WeakPtrTest, Reset) {
@@ -91,6 +105,57 @@ TEST(WeakPtrTest, Reset) {
     EXPECT_TRUE(weakPtr.expired());
 }
 
+TEST(WeakPtrTest, LockAfterExpired) {
+    WeakPtr<int> weakPtr;
+    {
+        SharedPtr<int> sharedPtr(new int(10));
+        weakPtr = sharedPtr;
+    }
+    SharedPtr<int> lockedPtr = weakPtr.lock();
+    EXPECT_EQ(lockedPtr.get(), nullptr);
+    EXPECT_EQ(lockedPtr.use_count(), 0);
+}
+
+TEST(WeakPtrTest, ConcurrentLockNeverResurrects) {
+    for (int round = 0; round < 200; ++round) {
+        std::atomic<int> destroyed{0};
+        SharedPtr<Tracked, AtomicPolicy> sharedPtr(new Tracked(&destroyed));
+        WeakPtr<Tracked, AtomicPolicy> weakPtr(sharedPtr);
+
+        std::thread locker([&weakPtr, &destroyed] {
+            for (int i = 0; i < 1000; ++i) {
+                SharedPtr<Tracked, AtomicPolicy> lockedPtr = weakPtr.lock();
+                if (lockedPtr) {
+                    EXPECT_EQ(destroyed.load(), 0);
+                }
+            }
+        });
+        sharedPtr = SharedPtr<Tracked, AtomicPolicy>();
+        locker.join();
+
+        EXPECT_TRUE(weakPtr.expired());
+        EXPECT_EQ(destroyed.load(), 1);
+    }
+}
+
+TEST(WeakPtrTest, ConvertingConstructors) {
+    struct Base {
+        virtual ~Base() = default;
+    };
+    struct Derived : Base {};
+
+    SharedPtr<Derived> sharedPtr(new Derived());
+    WeakPtr<Base> weakBase(sharedPtr);
+    EXPECT_EQ(weakBase.use_count(), 1);
+
+    WeakPtr<Derived> weakDerived(sharedPtr);
+    WeakPtr<Base> copied(weakDerived);
+    WeakPtr<Base> moved(std::move(weakDerived));
+    EXPECT_TRUE(weakDerived.expired());
+    EXPECT_EQ(moved.lock().get(), sharedPtr.get());
+    EXPECT_FALSE(copied.expired());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();